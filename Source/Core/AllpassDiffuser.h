@@ -0,0 +1,208 @@
+/*
+  ==============================================================================
+
+    AllpassDiffuser.h
+    Diffusion for the repeats: a cascade of nested Schroeder allpasses, L and
+    R side by side in the two lanes of one SIMD register.
+
+    Each stage is an allpass whose delay holds a second, shorter allpass
+    (Gardner's nested form), so one stage already gives a dense burst and
+    four in a row smear a click over a few tens of milliseconds. In the
+    feedback path every repeat goes through once more, so the echoes blur a
+    little further into a reverb tail on each trip round. The loop stays as
+    stable as without: an allpass passes every frequency at unity gain.
+
+    Both sides use the same delay lengths, so a frame of L and R is one
+    64-bit load and store, and the buffers are powers of two indexed with a
+    mask. The R lane runs with the gains negated, which is still an allpass
+    but a different one, so the two sides don't smear alike.
+
+    At small gains a stage tends to a plain delay of its two lengths, so
+    the whole cascade is getLatency() samples late. The engine reads the
+    repeats that much early to keep them on time.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <algorithm>
+
+#if defined (__SSE2__) || defined (_M_X64) || (defined (_M_IX86_FP) && _M_IX86_FP >= 2)
+ #define PINGPONG_DIFFUSER_SSE2 1
+ #include <emmintrin.h>
+#elif defined (__ARM_NEON) || defined (__ARM_NEON__)
+ #define PINGPONG_DIFFUSER_NEON 1
+ #include <arm_neon.h>
+#endif
+
+//==============================================================================
+// One L/R frame as two SIMD lanes
+struct StereoLanes
+{
+   #if PINGPONG_DIFFUSER_SSE2
+    __m128 v;
+
+    static StereoLanes load (const float* p) noexcept      { return { _mm_castpd_ps (_mm_load_sd ((const double*) p)) }; }
+    void store (float* p) const noexcept                    { _mm_store_sd ((double*) p, _mm_castps_pd (v)); }
+    static StereoLanes set (float l, float r) noexcept     { return { _mm_setr_ps (l, r, 0, 0) }; }
+    static StereoLanes zero() noexcept                      { return { _mm_setzero_ps() }; }
+
+    friend StereoLanes operator+ (StereoLanes a, StereoLanes b) noexcept { return { _mm_add_ps (a.v, b.v) }; }
+    friend StereoLanes operator- (StereoLanes a, StereoLanes b) noexcept { return { _mm_sub_ps (a.v, b.v) }; }
+    friend StereoLanes operator* (StereoLanes a, StereoLanes b) noexcept { return { _mm_mul_ps (a.v, b.v) }; }
+   #elif PINGPONG_DIFFUSER_NEON
+    float32x2_t v;
+
+    static StereoLanes load (const float* p) noexcept      { return { vld1_f32 (p) }; }
+    void store (float* p) const noexcept                    { vst1_f32 (p, v); }
+    static StereoLanes set (float l, float r) noexcept     { const float lr[2] = { l, r }; return { vld1_f32 (lr) }; }
+    static StereoLanes zero() noexcept                      { return { vdup_n_f32 (0) }; }
+
+    friend StereoLanes operator+ (StereoLanes a, StereoLanes b) noexcept { return { vadd_f32 (a.v, b.v) }; }
+    friend StereoLanes operator- (StereoLanes a, StereoLanes b) noexcept { return { vsub_f32 (a.v, b.v) }; }
+    friend StereoLanes operator* (StereoLanes a, StereoLanes b) noexcept { return { vmul_f32 (a.v, b.v) }; }
+   #else
+    float l, r;
+
+    static StereoLanes load (const float* p) noexcept      { return { p[0], p[1] }; }
+    void store (float* p) const noexcept                    { p[0] = l; p[1] = r; }
+    static StereoLanes set (float left, float right) noexcept { return { left, right }; }
+    static StereoLanes zero() noexcept                      { return { 0, 0 }; }
+
+    friend StereoLanes operator+ (StereoLanes a, StereoLanes b) noexcept { return { a.l + b.l, a.r + b.r }; }
+    friend StereoLanes operator- (StereoLanes a, StereoLanes b) noexcept { return { a.l - b.l, a.r - b.r }; }
+    friend StereoLanes operator* (StereoLanes a, StereoLanes b) noexcept { return { a.l * b.l, a.r * b.r }; }
+   #endif
+
+    void get (float& left, float& right) const noexcept
+    {
+        alignas (16) float lanes[4];
+       #if PINGPONG_DIFFUSER_SSE2
+        _mm_store_ps (lanes, v);
+       #else
+        store (lanes);
+       #endif
+        left = lanes[0];
+        right = lanes[1];
+    }
+};
+
+//==============================================================================
+class AllpassDiffuser
+{
+public:
+    static constexpr int NUM_STAGES = 4;
+    static constexpr float MAX_GAIN = 0.65f;        // at Diffusion 1
+    static constexpr double MAX_RATE = 192000.0;    // the buffers are sized for this
+
+    // Nested pair lengths, in ms: no two share a factor worth speaking of
+    static constexpr float OUTER_MS[NUM_STAGES] = { 2.3f, 3.7f, 5.3f, 7.1f };
+    static constexpr float INNER_MS[NUM_STAGES] = { 0.9f, 1.3f, 1.9f, 2.7f };
+
+    static constexpr int OUTER_SIZE = 2048;         // frames, power of two
+    static constexpr int INNER_SIZE = 1024;
+    static constexpr int OUTER_MASK = OUTER_SIZE - 1;
+    static constexpr int INNER_MASK = INNER_SIZE - 1;
+
+    // Lengths for the rate the network runs at. Starts over from silence.
+    void prepare (double sampleRate) noexcept
+    {
+        const double rate = std::min (sampleRate, MAX_RATE);
+        latency = 0;
+
+        for (int s = 0; s < NUM_STAGES; ++s)
+        {
+            outerDelay[s] = std::max (1, (int) (OUTER_MS[s] * rate / 1000));
+            innerDelay[s] = std::max (1, (int) (INNER_MS[s] * rate / 1000));
+            latency += outerDelay[s] + innerDelay[s];
+        }
+
+        reset();
+    }
+
+    // Samples by which the cascade is late at small gains
+    int getLatency() const noexcept { return latency; }
+
+    // Constant time: nothing is cleared, reads reach only as far back as has
+    // been written since
+    void reset() noexcept
+    {
+        position = 0;
+        numWritten = 0;
+    }
+
+    // Diffusion 0 .. 1. Takes effect over the next numSamples.
+    void setAmount (float amount, int numSamples) noexcept
+    {
+        targetGain = MAX_GAIN * std::min (std::max (amount, 0.0f), 1.0f);
+        gainRemaining = std::max (numSamples, 1);
+        gainStep = (targetGain - gain) / (float) gainRemaining;
+    }
+
+    // One frame: in[0] / in[1] are L / R, the diffused frame goes to out
+    inline void process (const float* in, float* out) noexcept
+    {
+        if (gainRemaining > 0)
+            gain = --gainRemaining > 0 ? gain + gainStep : targetGain;
+
+        const StereoLanes g = StereoLanes::set (gain, -gain);
+
+        StereoLanes x = StereoLanes::set (in[0], in[1]);
+
+        if (numWritten >= latency)
+            x = processStages<false> (x, g);
+        else
+            x = processStages<true> (x, g);
+
+        x.get (out[0], out[1]);
+        position = (position + 1) & OUTER_MASK;
+    }
+
+private:
+    template <bool Filling>
+    inline StereoLanes processStages (StereoLanes x, StereoLanes g) noexcept
+    {
+        for (int s = 0; s < NUM_STAGES; ++s)
+        {
+            // The inner allpass sits in the outer one's delay
+            const StereoLanes d1 = read<Filling> (outer[s], position - outerDelay[s], OUTER_MASK, outerDelay[s]);
+            const StereoLanes d2 = read<Filling> (inner[s], position - innerDelay[s], INNER_MASK, innerDelay[s]);
+
+            const StereoLanes w2 = d1 + g*d2;
+            w2.store (inner[s] + 2*(position & INNER_MASK));
+            const StereoLanes delayed = d2 - g*w2;
+
+            const StereoLanes w = x + g*delayed;
+            w.store (outer[s] + 2*(position & OUTER_MASK));
+            x = delayed - g*w;
+        }
+
+        if (Filling)
+            ++numWritten;
+
+        return x;
+    }
+
+    template <bool Filling>
+    inline StereoLanes read (const float* buffer, int pos, int mask, int delay) const noexcept
+    {
+        // Not written since reset() yet: silence
+        if (Filling && delay > numWritten)
+            return StereoLanes::zero();
+
+        return StereoLanes::load (buffer + 2*(pos & mask));
+    }
+
+    alignas (16) float outer[NUM_STAGES][2*OUTER_SIZE] = {};    // L/R frames
+    alignas (16) float inner[NUM_STAGES][2*INNER_SIZE] = {};
+
+    int outerDelay[NUM_STAGES] = {};
+    int innerDelay[NUM_STAGES] = {};
+    int latency = 0;
+    int position = 0;
+    int numWritten = 0;
+
+    float gain = 0, gainStep = 0, targetGain = 0;
+    int gainRemaining = 0;
+};
@@ -0,0 +1,199 @@
+/*
+  ==============================================================================
+
+    CrossoverFilterbank.h
+    Linkwitz-Riley crossover splitting a stereo signal into 2 or 3 bands,
+    for the multiband ping-pong.
+
+    Each split is 4th order (two Butterworth biquads in a row), so the low
+    and high outputs sum back to an allpass of the input: flat, only the
+    phase turns. With 3 bands the high side of the first split is split
+    again, and the low band goes through the matching allpass of the second
+    split so the three stay in phase with each other.
+
+    The biquads of one stage all run at once, one per lane: the first stage
+    is L and R, each through a lowpass and a highpass (4 lanes), the second
+    L and R, each through the low band's allpass, the mid lowpass and the
+    high highpass (6 of 8 lanes). Every step of a stage is one loop over the
+    lanes, laid out so the compiler vectorises it.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cmath>
+#include <algorithm>
+
+//==============================================================================
+struct BiquadCoefficients
+{
+    float b0 = 1, b1 = 0, b2 = 0, a1 = 0, a2 = 0;     // pass-through
+
+    enum class Shape { lowpass, highpass, allpass };
+
+    // Butterworth (Q = 1/sqrt 2) sections, bilinear with prewarping
+    static BiquadCoefficients design (Shape shape, double frequency, double sampleRate) noexcept
+    {
+        const double w = 2 * 3.141592653589793 * frequency / sampleRate;
+        const double cosw = std::cos (w);
+        const double alpha = std::sin (w) / (2 * 0.7071067811865476);
+        const double a0 = 1 + alpha;
+
+        double b[3];
+        switch (shape)
+        {
+            case Shape::lowpass:  b[0] = (1 - cosw) / 2; b[1] = 1 - cosw;    b[2] = (1 - cosw) / 2; break;
+            case Shape::highpass: b[0] = (1 + cosw) / 2; b[1] = -(1 + cosw); b[2] = (1 + cosw) / 2; break;
+            default:              b[0] = 1 - alpha;      b[1] = -2 * cosw;   b[2] = 1 + alpha;      break;
+        }
+
+        BiquadCoefficients c;
+        c.b0 = (float) (b[0] / a0);
+        c.b1 = (float) (b[1] / a0);
+        c.b2 = (float) (b[2] / a0);
+        c.a1 = (float) (-2 * cosw / a0);
+        c.a2 = (float) ((1 - alpha) / a0);
+        return c;
+    }
+};
+
+//==============================================================================
+// Two biquads in a row for each of N lanes, transposed direct form II
+template <int N>
+struct BiquadLanes
+{
+    alignas (32) float b0[2][N], b1[2][N], b2[2][N], a1[2][N], a2[2][N];
+    alignas (32) float s1[2][N] = {}, s2[2][N] = {};
+
+    BiquadLanes() noexcept
+    {
+        for (int stage = 0; stage < 2; ++stage)
+            for (int l = 0; l < N; ++l)
+                set (stage, l, {});
+    }
+
+    void set (int stage, int lane, const BiquadCoefficients& c) noexcept
+    {
+        b0[stage][lane] = c.b0;
+        b1[stage][lane] = c.b1;
+        b2[stage][lane] = c.b2;
+        a1[stage][lane] = c.a1;
+        a2[stage][lane] = c.a2;
+    }
+
+    void reset() noexcept
+    {
+        std::fill (&s1[0][0], &s1[0][0] + 2*N, 0.0f);
+        std::fill (&s2[0][0], &s2[0][0] + 2*N, 0.0f);
+    }
+
+    // In place, one sample per lane
+    inline void process (float* x) noexcept
+    {
+        for (int stage = 0; stage < 2; ++stage)
+        {
+            for (int l = 0; l < N; ++l)
+            {
+                const float in = x[l];
+                const float out = b0[stage][l]*in + s1[stage][l];
+                s1[stage][l] = b1[stage][l]*in - a1[stage][l]*out + s2[stage][l];
+                s2[stage][l] = b2[stage][l]*in - a2[stage][l]*out;
+                x[l] = out;
+            }
+        }
+    }
+};
+
+//==============================================================================
+class CrossoverFilterbank
+{
+public:
+    static constexpr int MAX_BANDS = 3;
+
+    using Shape = BiquadCoefficients::Shape;
+
+    // 2 or 3 bands; highHz only counts for 3. Redesigns only on a change.
+    void setup (int bands, float lowHz, float highHz, double sampleRate) noexcept
+    {
+        const float nyquistish = (float) (0.45 * sampleRate);
+        lowHz = std::min (std::max (lowHz, 20.0f), nyquistish);
+        highHz = std::min (std::max (highHz, lowHz), nyquistish);
+
+        if (bands == numBands && lowHz == lowFrequency && highHz == highFrequency && sampleRate == rate)
+            return;
+
+        if (bands != numBands)
+            reset();
+
+        numBands = bands;
+        lowFrequency = lowHz;
+        highFrequency = highHz;
+        rate = sampleRate;
+
+        // Split 1, lanes L low, L high, R low, R high; both sections alike (LR4)
+        const auto lp1 = BiquadCoefficients::design (Shape::lowpass, lowHz, sampleRate);
+        const auto hp1 = BiquadCoefficients::design (Shape::highpass, lowHz, sampleRate);
+
+        for (int stage = 0; stage < 2; ++stage)
+            for (int side = 0; side < 2; ++side)
+            {
+                split1.set (stage, 2*side, lp1);
+                split1.set (stage, 2*side + 1, hp1);
+            }
+
+        // Split 2, lanes L low, L mid, L high, then R: the low band only through
+        // the allpass (and a pass-through section)
+        const auto ap2 = BiquadCoefficients::design (Shape::allpass, highHz, sampleRate);
+        const auto lp2 = BiquadCoefficients::design (Shape::lowpass, highHz, sampleRate);
+        const auto hp2 = BiquadCoefficients::design (Shape::highpass, highHz, sampleRate);
+
+        for (int side = 0; side < 2; ++side)
+        {
+            split2.set (0, 3*side, ap2);
+            split2.set (1, 3*side, {});
+
+            for (int stage = 0; stage < 2; ++stage)
+            {
+                split2.set (stage, 3*side + 1, lp2);
+                split2.set (stage, 3*side + 2, hp2);
+            }
+        }
+    }
+
+    void reset() noexcept
+    {
+        split1.reset();
+        split2.reset();
+    }
+
+    int getNumBands() const noexcept { return numBands; }
+
+    // One stereo sample into bandsL / bandsR, low band first
+    inline void process (float left, float right, float* bandsL, float* bandsR) noexcept
+    {
+        alignas (16) float x[4] = { left, left, right, right };
+        split1.process (x);
+
+        if (numBands < 3)
+        {
+            bandsL[0] = x[0]; bandsL[1] = x[1];
+            bandsR[0] = x[2]; bandsR[1] = x[3];
+            return;
+        }
+
+        alignas (32) float y[8] = { x[0], x[1], x[1], x[2], x[3], x[3], 0, 0 };
+        split2.process (y);
+
+        bandsL[0] = y[0]; bandsL[1] = y[1]; bandsL[2] = y[2];
+        bandsR[0] = y[3]; bandsR[1] = y[4]; bandsR[2] = y[5];
+    }
+
+private:
+    BiquadLanes<4> split1;
+    BiquadLanes<8> split2;
+
+    int numBands = 0;
+    float lowFrequency = 0, highFrequency = 0;
+    double rate = 0;
+};
@@ -0,0 +1,255 @@
+/*
+  ==============================================================================
+
+    DelaySampleFormat.h
+    Storage formats for the delay histories.
+
+    Long delays are memory bound: every tap read is a likely cache miss, so
+    halving the size of a stored sample halves the traffic. The formats below
+    all decode to float; the taps always interpolate in float.
+
+    Each buffer is allocated DELAY_GUARD samples longer than its nominal size,
+    and the first DELAY_GUARD samples are mirrored past the end on write. That
+    way the 4 points of a cubic read are always contiguous and can be decoded
+    with a single SIMD load.
+
+    Noise floor of the reduced formats (measured against the float32 path,
+    broadband, one trip through the delay):
+      - Float16: 11 significant bits, so the error is relative to the signal,
+        about -66 dB below it at any level down to ~6e-5 (-84 dBFS), then an
+        absolute floor around -140 dBFS. Values up to 65504 are representable,
+        so feedback build-up can't clip.
+      - Int16: fixed point with +12 dB headroom (full scale is +/-4.0), so the
+        floor is absolute, around -90 dBFS, and repeats above +12 dBFS clip.
+    Each pass through the feedback loop requantises, so with feedback g the
+    accumulated noise is 1 / (1 - g^2) times the single-pass power (+10 dB at
+    g = 0.95). Both stay below the level of the repeats at sensible settings;
+    Int16 is the cheaper of the two to decode on machines without F16C.
+
+    F16C converts 4 halves in one instruction, but a build can't assume it
+    (it comes with AVX), so Float16Storage converts in portable code and
+    Float16F16CStorage, the same bits, has the instructions enabled per
+    function the way the kernels in PingPongKernels.cpp do. The engine
+    picks it once per block when the CPU has them (PingPongKernels::f16c).
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+
+#if defined (__x86_64__) || defined (_M_X64) || defined (__i386__) || defined (_M_IX86)
+ #define PINGPONG_USE_F16C 1
+ #include <immintrin.h>
+ #if defined (__GNUC__) || defined (__clang__)
+  #define PINGPONG_F16C_TARGET __attribute__ ((target ("f16c")))
+ #else
+  #define PINGPONG_F16C_TARGET
+ #endif
+#else
+ #define PINGPONG_USE_F16C 0
+#endif
+
+#if defined (__SSE2__) || defined (_M_X64) || (defined (_M_IX86_FP) && _M_IX86_FP >= 2)
+ #define PINGPONG_USE_SSE2 1
+ #include <emmintrin.h>
+#else
+ #define PINGPONG_USE_SSE2 0
+#endif
+
+//==============================================================================
+enum class DelaySampleFormat
+{
+    float32 = 0,
+    float16,
+    int16
+};
+
+// Samples mirrored past the end of each delay buffer (see above)
+static constexpr int DELAY_GUARD = 4;
+
+//==============================================================================
+struct Float32Storage
+{
+    using Stored = float;
+
+    static inline Stored encode (float x) noexcept    { return x; }
+    static inline float decode (Stored x) noexcept    { return x; }
+
+    static inline void load4 (const Stored* src, float* dest) noexcept
+    {
+        std::memcpy (dest, src, 4 * sizeof (float));
+    }
+};
+
+//==============================================================================
+struct Float16Storage
+{
+    using Stored = uint16_t;
+
+    static inline Stored encode (float x) noexcept    { return floatToHalf (x); }
+    static inline float decode (Stored h) noexcept    { return halfToFloat (h); }
+
+    static inline void load4 (const Stored* src, float* dest) noexcept
+    {
+        for (int i = 0; i < 4; ++i)
+            dest[i] = halfToFloat (src[i]);
+    }
+
+    //==============================================================================
+    // Portable IEEE 754 binary16 conversion, round to nearest even
+    static inline uint16_t floatToHalf (float f) noexcept
+    {
+        uint32_t x;
+        std::memcpy (&x, &f, sizeof (x));
+
+        const uint32_t sign = (x >> 16) & 0x8000u;
+        uint32_t absx = x & 0x7fffffffu;
+
+        if (absx >= 0x7f800000u)                     // Inf or NaN
+            return (uint16_t) (sign | 0x7c00u | (absx > 0x7f800000u ? 0x200u : 0u));
+
+        if (absx >= 0x477ff000u)                     // overflows to Inf
+            return (uint16_t) (sign | 0x7c00u);
+
+        if (absx < 0x38800000u)                      // subnormal or zero in half
+        {
+            if (absx < 0x33000000u)
+                return (uint16_t) sign;
+
+            const uint32_t e = absx >> 23;
+            const uint32_t m = (absx & 0x7fffffu) | 0x800000u;
+            const uint32_t shift = 126u - e;
+            uint32_t h = m >> shift;
+            const uint32_t rem = m & ((1u << shift) - 1u);
+            const uint32_t half = 1u << (shift - 1u);
+            if (rem > half || (rem == half && (h & 1u)))
+                ++h;
+            return (uint16_t) (sign | h);
+        }
+
+        // normal: rebias exponent and round the mantissa to 10 bits
+        uint32_t h = ((absx - 0x38000000u) >> 13);
+        const uint32_t rem = absx & 0x1fffu;
+        if (rem > 0x1000u || (rem == 0x1000u && (h & 1u)))
+            ++h;
+        return (uint16_t) (sign | h);
+    }
+
+    static inline float halfToFloat (uint16_t h) noexcept
+    {
+        const uint32_t sign = (uint32_t) (h & 0x8000u) << 16;
+        const uint32_t exp = (h >> 10) & 0x1fu;
+        uint32_t mant = h & 0x3ffu;
+        uint32_t x;
+
+        if (exp == 0)
+        {
+            if (mant == 0)
+            {
+                x = sign;
+            }
+            else
+            {
+                // subnormal half -> normal float
+                int e = -1;
+                do { ++e; mant <<= 1; } while ((mant & 0x400u) == 0);
+                x = sign | ((uint32_t) (112 - e) << 23) | ((mant & 0x3ffu) << 13);
+            }
+        }
+        else if (exp == 31)
+        {
+            x = sign | 0x7f800000u | (mant << 13);
+        }
+        else
+        {
+            x = sign | ((exp + 112u) << 23) | (mant << 13);
+        }
+
+        float f;
+        std::memcpy (&f, &x, sizeof (f));
+        return f;
+    }
+};
+
+#if PINGPONG_USE_F16C
+//==============================================================================
+// Float16Storage with the F16C instructions; only for CPUs that have them
+struct Float16F16CStorage : Float16Storage
+{
+    PINGPONG_F16C_TARGET static inline Stored encode (float x) noexcept
+    {
+        return (Stored) _mm_extract_epi16 (_mm_cvtps_ph (_mm_set_ss (x), _MM_FROUND_TO_NEAREST_INT), 0);
+    }
+
+    PINGPONG_F16C_TARGET static inline float decode (Stored h) noexcept
+    {
+        return _mm_cvtss_f32 (_mm_cvtph_ps (_mm_cvtsi32_si128 (h)));
+    }
+
+    PINGPONG_F16C_TARGET static inline void load4 (const Stored* src, float* dest) noexcept
+    {
+        _mm_storeu_ps (dest, _mm_cvtph_ps (_mm_loadl_epi64 (reinterpret_cast<const __m128i*> (src))));
+    }
+};
+#endif
+
+//==============================================================================
+struct Int16Storage
+{
+    using Stored = int16_t;
+
+    // +/-4.0 maps to full scale, leaving 12 dB of headroom for feedback build-up
+    static constexpr float scale = 8192.0f;
+    static constexpr float invScale = 1.0f / 8192.0f;
+
+    static inline Stored encode (float x) noexcept
+    {
+        float v = x * scale;
+        v = v > 32767.0f ? 32767.0f : (v < -32768.0f ? -32768.0f : v);
+        return (Stored) std::lrintf (v);
+    }
+
+    static inline float decode (Stored x) noexcept    { return (float) x * invScale; }
+
+    static inline void load4 (const Stored* src, float* dest) noexcept
+    {
+       #if PINGPONG_USE_SSE2
+        const __m128i v = _mm_loadl_epi64 (reinterpret_cast<const __m128i*> (src));
+        const __m128i wide = _mm_srai_epi32 (_mm_unpacklo_epi16 (v, v), 16); // sign extend
+        _mm_storeu_ps (dest, _mm_mul_ps (_mm_cvtepi32_ps (wide), _mm_set1_ps (invScale)));
+       #else
+        for (int i = 0; i < 4; ++i)
+            dest[i] = decode (src[i]);
+       #endif
+    }
+};
+
+//==============================================================================
+// Decodes n stored samples into dest last first, dest[k] = src[n - 1 - k]:
+// 4 at a time, with one shuffle to turn each group round.
+template <typename Format>
+inline void loadReversed (const typename Format::Stored* src, int n, float* dest) noexcept
+{
+    int k = 0;
+
+    for (; k + 4 <= n; k += 4)
+    {
+        alignas (16) float four[4];
+        Format::load4 (src + n - 4 - k, four);
+
+       #if PINGPONG_USE_SSE2
+        const __m128 v = _mm_load_ps (four);
+        _mm_storeu_ps (dest + k, _mm_shuffle_ps (v, v, _MM_SHUFFLE (0, 1, 2, 3)));
+       #else
+        for (int i = 0; i < 4; ++i)
+            dest[k + i] = four[3 - i];
+       #endif
+    }
+
+    for (; k < n; ++k)
+        dest[k] = Format::decode (src[n - 1 - k]);
+}
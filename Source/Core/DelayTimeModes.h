@@ -0,0 +1,208 @@
+/*
+  ==============================================================================
+
+    DelayTimeModes.h
+    What the taps do when a delay time changes.
+
+      - Jump: the read position follows the (lightly smoothed) delay time, so
+        a change is heard as a click, like the "jump" mode of Ableton's Delay.
+      - Fade: the taps stay at the old time, a second set starts at the new one
+        and the two are crossfaded at equal power. The second set only runs
+        while a crossfade is in progress.
+      - Tape: the read position slews towards the new time at a bounded rate,
+        so the repeats bend in pitch like a tape delay whose head moves. The
+        rate is in seconds of delay per second, so it sounds the same at any
+        sample rate. When the head moves fast enough to pitch the repeats up
+        noticeably, each output sample averages several reads spread over the
+        stretch of tape it passes over, a box prefilter against aliasing.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cmath>
+
+//==============================================================================
+enum class DelayTimeMode
+{
+    jump = 0,
+    fade,
+    tape
+};
+
+// Integer / fractional split of a delay time, as read by the cubic taps
+struct DelayTap
+{
+    int samples = 0;
+    float frac = 0;
+
+    static DelayTap fromSamples (float delaySamples) noexcept
+    {
+        DelayTap t;
+        const float whole = std::floor (delaySamples);
+        t.samples = (int) whole;
+        t.frac = delaySamples - whole;
+        return t;
+    }
+
+    // The split that reads exactly delaySamples back. The cubic moves frac
+    // samples towards the write head, so this rounds up and comes back;
+    // fromSamples() only matches it on whole samples, which is all a delay
+    // at rest needs, but a moving one would be read at 2*floor(d) - d and
+    // saw up and down in pitch. Truncation and a compare, no libm call.
+    static DelayTap fromMovingSamples (float delaySamples) noexcept
+    {
+        DelayTap t;
+        t.samples = (int) delaySamples;
+        if ((float) t.samples < delaySamples)
+            ++t.samples;
+        t.frac = (float) t.samples - delaySamples;
+        return t;
+    }
+};
+
+// The taps of one side for the current sample: a single tap, or two being
+// crossfaded (gainA for the outgoing time, gainB for the incoming one).
+// In Tape mode tap a can instead be the first of numSubTaps reads, each
+// subStep samples less delayed than the previous, to be averaged.
+struct DelayTapSet
+{
+    DelayTap a, b;
+    float gainA = 1, gainB = 0;
+    bool fading = false;
+
+    int numSubTaps = 1;
+    float aSamples = 0;   // unsplit delay of tap a, for the sub-taps
+    float subStep = 0;
+};
+
+//==============================================================================
+// Crossfades between delay times for one side. Changes arriving while a fade
+// is running are picked up when it finishes.
+class DelayTimeFade
+{
+public:
+    void reset (float delayMs) noexcept
+    {
+        currentMs = nextMs = delayMs;
+        remaining = 0;
+    }
+
+    void setFadeLength (int numSamples) noexcept
+    {
+        length = numSamples > 1 ? numSamples : 1;
+    }
+
+    bool isFading() const noexcept     { return remaining > 0; }
+    float getCurrentMs() const noexcept { return currentMs; }
+
+    // Advances by one sample and returns the taps to read
+    DelayTapSet next (float targetMs, float samplesPerMs) noexcept
+    {
+        DelayTapSet taps;
+
+        if (remaining == 0 && targetMs != currentMs)
+        {
+            nextMs = targetMs;
+            remaining = length;
+        }
+
+        taps.a = DelayTap::fromSamples (currentMs * samplesPerMs);
+
+        if (remaining > 0)
+        {
+            // equal power: cos / sin over a quarter period
+            const float t = (float) (length - remaining + 1) / (float) length;
+            const float angle = t * 1.5707963267948966f;
+
+            taps.b = DelayTap::fromSamples (nextMs * samplesPerMs);
+            taps.gainA = std::cos (angle);
+            taps.gainB = std::sin (angle);
+            taps.fading = true;
+
+            if (--remaining == 0)
+                currentMs = nextMs;
+        }
+
+        return taps;
+    }
+
+private:
+    float currentMs = 0;
+    float nextMs = 0;
+    int remaining = 0;
+    int length = 1;
+};
+
+//==============================================================================
+// Rate limited read head for one side (Tape mode).
+class DelayTimeSlew
+{
+public:
+    void reset (double delaySamples) noexcept
+    {
+        current = delaySamples;
+        velocity = 0;
+    }
+
+    // maxRate: largest delay change per sample (0.5 = repeats between half and
+    // 1.5x speed). settleSamples: how long the head takes to come to rest on
+    // the target, so it decelerates instead of stopping dead.
+    void setRate (float maxRate, float settleSamples) noexcept
+    {
+        maxVelocity = maxRate;
+        invSettle = settleSamples > 1 ? 1.0f / settleSamples : 1.0f;
+    }
+
+    bool isMoving() const noexcept          { return velocity != 0; }
+    double getCurrentSamples() const noexcept { return current; }
+
+    // Advances by one sample and returns the taps to read
+    DelayTapSet next (double targetSamples) noexcept
+    {
+        DelayTapSet taps;
+
+        const double distance = targetSamples - current;
+
+        if (std::abs (distance) < 1.0e-4)
+        {
+            current = targetSamples;
+            velocity = 0;
+        }
+        else
+        {
+            // proportional approach, capped at the maximum rate
+            double v = distance * invSettle;
+            v = v > maxVelocity ? maxVelocity : (v < -maxVelocity ? -maxVelocity : v);
+            velocity = (float) v;
+            current += v;
+        }
+
+        const float delaySamples = (float) current;
+        taps.a = DelayTap::fromMovingSamples (delaySamples);
+
+        // playback speed of the repeats; above ~1.25x the pitched-up content
+        // starts folding over Nyquist, so spread the read over the tape passed
+        const float speed = 1.0f - velocity;
+
+        if (speed > AA_SPEED)
+        {
+            const int n = speed > 2.0f * AA_SPEED ? 4 : 2;
+            taps.numSubTaps = n;
+            taps.subStep = speed / (float) n;
+            taps.aSamples = delaySamples + 0.5f * speed - 0.5f * taps.subStep;
+            taps.a = DelayTap::fromMovingSamples (taps.aSamples);
+        }
+
+        return taps;
+    }
+
+private:
+    static constexpr float AA_SPEED = 1.25f;
+
+    double current = 0;
+    float velocity = 0;
+    float maxVelocity = 0.5f;
+    float invSettle = 1.0f;
+};
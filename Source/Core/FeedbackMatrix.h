@@ -0,0 +1,152 @@
+/*
+  ==============================================================================
+
+    FeedbackMatrix.h
+    Orthogonal feedback matrices for the FDN mode, applied in place to the
+    vector of delay line outputs.
+
+    Orthogonal means energy preserving, so how fast the network dies away is
+    set by the per-line feedback gains alone. Hadamard is applied as a fast
+    Walsh-Hadamard transform (N log2 N adds and one scale), Householder
+    (I - 2/N * ones) as one sum and N subtractions, and a user matrix as a
+    dense product laid out by column, one multiply-add over the whole
+    vector per column, so the compiler vectorises it. The plain ping-pong
+    is the 2-line case with the swap matrix [0 1; 1 0].
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cmath>
+
+//==============================================================================
+enum class FeedbackMatrixType
+{
+    hadamard = 0,
+    householder,
+    user
+};
+
+inline const char* getFeedbackMatrixName (FeedbackMatrixType type) noexcept
+{
+    switch (type)
+    {
+        case FeedbackMatrixType::householder: return "Householder";
+        case FeedbackMatrixType::user:        return "User";
+        default:                              return "Hadamard";
+    }
+}
+
+//==============================================================================
+template <int N>
+inline void applyHadamard (float* x) noexcept
+{
+    static_assert ((N & (N - 1)) == 0, "Hadamard needs a power of two");
+
+    for (int h = 1; h < N; h *= 2)
+    {
+        for (int i = 0; i < N; i += 2*h)
+        {
+            for (int j = i; j < i + h; ++j)
+            {
+                const float a = x[j], b = x[j + h];
+                x[j] = a + b;
+                x[j + h] = a - b;
+            }
+        }
+    }
+
+    const float scale = 1.0f / std::sqrt ((float) N);
+    for (int i = 0; i < N; ++i)
+        x[i] *= scale;
+}
+
+template <int N>
+inline void applyHouseholder (float* x) noexcept
+{
+    float sum = 0;
+    for (int i = 0; i < N; ++i)
+        sum += x[i];
+
+    const float reflect = sum * (2.0f / N);
+    for (int i = 0; i < N; ++i)
+        x[i] -= reflect;
+}
+
+//==============================================================================
+struct UserFeedbackMatrix
+{
+    static constexpr int MAX_SIZE = 16;
+
+    float columns[MAX_SIZE][MAX_SIZE] = {};     // columns[c][r] = M(r, c)
+    int size = 0;
+
+    // rows: size * size values, row by row. The rows are orthonormalised
+    // (Gram-Schmidt, in order), so any matrix given makes a stable loop; a
+    // row that depends on the ones before it is replaced by a unit vector.
+    // Returns false, and leaves the matrix as it was, unless size is 4, 8 or 16.
+    bool set (const float* rows, int n) noexcept
+    {
+        if (n != 4 && n != 8 && n != 16)
+            return false;
+
+        double q[MAX_SIZE][MAX_SIZE];
+
+        for (int r = 0; r < n; ++r)
+        {
+            for (int attempt = 0; attempt <= n; ++attempt)
+            {
+                // The given row first, then unit vectors until one is independent
+                for (int c = 0; c < n; ++c)
+                    q[r][c] = attempt == 0 ? (double) rows[r*n + c] : (c == attempt - 1 ? 1.0 : 0.0);
+
+                for (int k = 0; k < r; ++k)
+                {
+                    double dot = 0;
+                    for (int c = 0; c < n; ++c)
+                        dot += q[r][c] * q[k][c];
+
+                    for (int c = 0; c < n; ++c)
+                        q[r][c] -= dot * q[k][c];
+                }
+
+                double norm = 0;
+                for (int c = 0; c < n; ++c)
+                    norm += q[r][c] * q[r][c];
+
+                norm = std::sqrt (norm);
+                if (norm > 1.0e-3)
+                {
+                    for (int c = 0; c < n; ++c)
+                        q[r][c] /= norm;
+
+                    break;
+                }
+            }
+        }
+
+        for (int r = 0; r < n; ++r)
+            for (int c = 0; c < n; ++c)
+                columns[c][r] = (float) q[r][c];
+
+        size = n;
+        return true;
+    }
+
+    template <int N>
+    void apply (float* x) const noexcept
+    {
+        float y[N] = {};
+
+        for (int c = 0; c < N; ++c)
+        {
+            const float xc = x[c];
+            for (int r = 0; r < N; ++r)
+                y[r] += columns[c][r] * xc;
+        }
+
+        for (int r = 0; r < N; ++r)
+            x[r] = y[r];
+    }
+};
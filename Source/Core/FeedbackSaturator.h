@@ -0,0 +1,116 @@
+/*
+  ==============================================================================
+
+    FeedbackSaturator.h
+    Drive: a soft clipper on what the ping-pong writes back into its
+    cross-feedback histories, so the repeats saturate more the harder the
+    loop is driven.
+
+    The curve is the cubic soft clip u - u^3/3, flat at +-2/3 past |u| = 1,
+    at a pre-gain that grows with the drive and is divided out again, so
+    small signals pass at unity and only the level the loop builds up to
+    is squashed.
+
+    Aliasing is kept down with first-order antiderivative antialiasing
+    (ADAA): each output is the mean of the curve between the previous input
+    and this one, (F(u[n]) - F(u[n-1])) / (u[n] - u[n-1]) with F the
+    curve's antiderivative, which is one more polynomial per sample. It
+    delays the signal by half a sample; the engine reads the repeats that
+    much early. For offline renders (sinc taps) the clipper can also run at
+    twice the rate between the Economy half-band filters, for a few more
+    samples of latency, taken off the same way.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cmath>
+#include "HalfBandFilter.h"
+
+//==============================================================================
+class FeedbackSaturator
+{
+public:
+    // drive 0 .. 1; 0 keeps the last pre-gain, for fading out
+    void setDrive (float drive) noexcept
+    {
+        if (drive > 0)
+        {
+            preGain = MAX_PRE_GAIN * drive * drive;
+            postGain = 1 / preGain;
+        }
+    }
+
+    void reset (bool shouldOversample) noexcept
+    {
+        oversampled = shouldOversample;
+        previousU = previousF = 0;
+        interpolator.reset();
+        decimator.reset();
+    }
+
+    bool isOversampled() const noexcept { return oversampled; }
+
+    // In samples of the rate it is fed at
+    float getLatency() const noexcept
+    {
+        return oversampled ? OVERSAMPLED_LATENCY : 0.5f;
+    }
+
+    inline float process (float x) noexcept
+    {
+        if (! oversampled)
+            return shape (x);
+
+        float up[2], y = 0;
+        interpolator.push (x, up);
+        decimator.push (shape (up[0]), y);
+        decimator.push (shape (up[1]), y);
+        return y;
+    }
+
+private:
+    static constexpr float MAX_PRE_GAIN = 3.0f;     // at drive 1 the loop tops out at 2/9
+    static constexpr float EPSILON = 1.0e-3f;       // closer inputs take the curve at their midpoint
+
+    // Interpolator, clipper and decimator, in samples at the lower rate
+    static constexpr float OVERSAMPLED_LATENCY = 0.5f * (float) (HalfBandInterpolator::LATENCY + HalfBandDecimator::LATENCY - 1) + 0.25f;
+
+    static inline float curve (float u) noexcept
+    {
+        if (u >= 1) return 2.0f / 3.0f;
+        if (u <= -1) return -2.0f / 3.0f;
+        return u - u*u*u * (1.0f / 3.0f);
+    }
+
+    static inline float antiderivative (float u) noexcept
+    {
+        const float a = std::fabs (u);
+        if (a >= 1)
+            return (2.0f / 3.0f) * a - 0.25f;
+
+        const float u2 = u*u;
+        return u2 * (0.5f - u2 * (1.0f / 12.0f));
+    }
+
+    inline float shape (float x) noexcept
+    {
+        const float u = preGain * x;
+        const float F = antiderivative (u);
+        const float d = u - previousU;
+
+        const float y = std::fabs (d) > EPSILON ? (F - previousF) / d
+                                                : curve (0.5f * (u + previousU));
+        previousU = u;
+        previousF = F;
+        return y * postGain;
+    }
+
+    float preGain = 1, postGain = 1;
+    float previousU = 0, previousF = 0;
+    bool oversampled = false;
+
+    HalfBandInterpolator interpolator;
+    HalfBandDecimator decimator;
+};
@@ -0,0 +1,150 @@
+/*
+  ==============================================================================
+
+    HalfBandFilter.h
+    Polyphase half-band decimator and interpolator (factor 2), for running
+    the delay network at a fraction of the host rate (Economy mode).
+
+    Linear phase FIR, 23 taps, Kaiser windowed: flat to about 0.17 of the
+    input rate, about -70 dB from 0.33 up. In a half-band filter every other
+    tap is zero apart from the centre one, and only every other output is
+    kept (decimator) or every other input is non-zero (interpolator), so
+    each output costs K multiplies instead of 23.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cmath>
+#include <cstring>
+
+//==============================================================================
+struct HalfBandCoefficients
+{
+    static constexpr int K = 6;             // non-zero taps each side of the centre
+    static constexpr int CENTRE = 2*K - 1;  // taps are -CENTRE .. CENTRE
+
+    float h[K];                             // taps 1, 3, 5 .. CENTRE
+
+    HalfBandCoefficients() noexcept
+    {
+        // Windowed sinc at a quarter of the rate, normalised so the DC gain is exactly 1
+        const double beta = 7.0;
+        double sum = 0;
+
+        for (int k = 0; k < K; ++k)
+        {
+            const int n = 2*k + 1;
+            const double x = (double) n / (double) (CENTRE + 1);
+            const double sinc = std::sin (1.5707963267948966 * n) / (3.141592653589793 * n);
+            h[k] = (float) (sinc * besselI0 (beta * std::sqrt (1 - x*x)) / besselI0 (beta));
+            sum += h[k];
+        }
+
+        for (auto& c : h)
+            c = (float) (c * 0.25 / sum);
+    }
+
+    static const HalfBandCoefficients& get() noexcept
+    {
+        static const HalfBandCoefficients coefficients;
+        return coefficients;
+    }
+
+private:
+    static double besselI0 (double x) noexcept
+    {
+        double sum = 1, term = 1;
+        for (int i = 1; i < 30; ++i)
+        {
+            term *= (x / (2*i)) * (x / (2*i));
+            sum += term;
+        }
+        return sum;
+    }
+};
+
+//==============================================================================
+// Two samples in, one out
+class HalfBandDecimator
+{
+public:
+    static constexpr int K = HalfBandCoefficients::K;
+    static constexpr int LATENCY = HalfBandCoefficients::CENTRE;   // in input samples
+
+    void reset() noexcept
+    {
+        std::memset (history, 0, sizeof (history));
+        pos = 0;
+        odd = false;
+    }
+
+    // Returns true, with the output in y, on every second input
+    bool push (float x, float& y) noexcept
+    {
+        history[pos] = history[pos + SIZE] = x;
+        const float* newest = history + pos + SIZE;
+
+        if (++pos == SIZE)
+            pos = 0;
+
+        odd = ! odd;
+        if (odd)
+            return false;
+
+        const float* centre = newest - LATENCY;
+        const auto& h = HalfBandCoefficients::get().h;
+
+        float sum = 0.5f * centre[0];
+        for (int k = 0; k < K; ++k)
+            sum += h[k] * (centre[-(2*k + 1)] + centre[2*k + 1]);
+
+        y = sum;
+        return true;
+    }
+
+private:
+    static constexpr int SIZE = 32;    // >= 2*CENTRE + 1, mirrored so reads never wrap
+    float history[2 * SIZE] = {};
+    int pos = 0;
+    bool odd = false;
+};
+
+//==============================================================================
+// One sample in, two out
+class HalfBandInterpolator
+{
+public:
+    static constexpr int K = HalfBandCoefficients::K;
+    static constexpr int LATENCY = 2*K;    // in output samples
+
+    void reset() noexcept
+    {
+        std::memset (history, 0, sizeof (history));
+        pos = 0;
+    }
+
+    void push (float x, float* y) noexcept
+    {
+        history[pos] = history[pos + SIZE] = x;
+        const float* centre = history + pos + SIZE - K;
+
+        if (++pos == SIZE)
+            pos = 0;
+
+        const auto& h = HalfBandCoefficients::get().h;
+
+        float sum = 0;
+        for (int k = 0; k < K; ++k)
+            sum += h[k] * (centre[-k] + centre[k + 1]);
+
+        y[0] = centre[0];
+        y[1] = 2 * sum;
+    }
+
+private:
+    static constexpr int SIZE = 16;    // >= 2*K, mirrored so reads never wrap
+    float history[2 * SIZE] = {};
+    int pos = 0;
+};
@@ -0,0 +1,545 @@
+/*
+  ==============================================================================
+
+    PartitionedConvolver.h
+    Short impulse responses (tape head, speaker, spring) in the feedback
+    path, so that every repeat is coloured by them.
+
+    Uniformly partitioned overlap-save convolution: the IR is cut into
+    PARTITION_SIZE sample partitions, each kept as a spectrum, and every
+    PARTITION_SIZE input samples one FFT of the newest input, a multiply-add
+    over all partitions and one inverse FFT give the next PARTITION_SIZE
+    output samples. The output is exactly PARTITION_SIZE samples late, which
+    the engine takes off the tap that feeds the convolver, so the coloured
+    repeats stay where the plain ones would be. That needs the IR to be at
+    least one partition shorter than the delay (otherwise the loop would need
+    output it hasn't got yet); below that the side falls back to plain
+    repeats. Either way the side's feedback gain still sets the decay.
+
+    Everything that allocates or builds spectra happens in create(), on the
+    message thread. ConvolutionSlot hands the result to the audio thread with
+    one atomic swap, and crossfades from what was there before.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cmath>
+#include <memory>
+#include <vector>
+#include <atomic>
+#include <algorithm>
+
+//==============================================================================
+// Real FFT of n points (a power of two), computed as a complex FFT of n/2
+// points. Split real / imaginary arrays of n/2 + 1 bins. inverse() undoes
+// forward(), scaling included.
+class RealFft
+{
+public:
+    explicit RealFft (int numPoints)
+        : n (numPoints), half (numPoints/2),
+          bitReverse ((size_t) half), cosTable ((size_t) half), sinTable ((size_t) half),
+          zr ((size_t) half), zi ((size_t) half)
+    {
+        int bits = 0;
+        while ((1 << bits) < half)
+            ++bits;
+
+        for (int i = 0; i < half; ++i)
+        {
+            int r = 0;
+            for (int b = 0; b < bits; ++b)
+                r |= ((i >> b) & 1) << (bits - 1 - b);
+
+            bitReverse[(size_t) i] = r;
+        }
+
+        // e^(-2 pi i k / n): the half size transform uses every other one
+        for (int k = 0; k < half; ++k)
+        {
+            cosTable[(size_t) k] = (float) std::cos (2*3.141592653589793*k / n);
+            sinTable[(size_t) k] = (float) -std::sin (2*3.141592653589793*k / n);
+        }
+    }
+
+    int getSize() const noexcept { return n; }
+
+    void forward (const float* input, float* re, float* im) noexcept
+    {
+        for (int k = 0; k < half; ++k)
+        {
+            const int j = bitReverse[(size_t) k];
+            zr[(size_t) k] = input[2*j];
+            zi[(size_t) k] = input[2*j + 1];
+        }
+
+        transform (false);
+
+        // Untangle the even and odd samples' spectra
+        re[0] = zr[0] + zi[0];
+        im[0] = 0;
+        re[half] = zr[0] - zi[0];
+        im[half] = 0;
+
+        for (int k = 1; k < half; ++k)
+        {
+            const float ar = zr[(size_t) k], ai = zi[(size_t) k];
+            const float br = zr[(size_t) (half - k)], bi = -zi[(size_t) (half - k)];
+
+            const float er = 0.5f*(ar + br), ei = 0.5f*(ai + bi);
+            const float orr = 0.5f*(ai - bi), oi = -0.5f*(ar - br);
+
+            const float wr = cosTable[(size_t) k], wi = sinTable[(size_t) k];
+            re[k] = er + wr*orr - wi*oi;
+            im[k] = ei + wr*oi + wi*orr;
+        }
+    }
+
+    void inverse (const float* re, const float* im, float* output) noexcept
+    {
+        const float scale = 1.0f / (float) half;
+
+        for (int k = 0; k < half; ++k)
+        {
+            const float ar = re[k], ai = im[k];
+            const float br = re[half - k], bi = -im[half - k];
+
+            const float er = 0.5f*(ar + br), ei = 0.5f*(ai + bi);
+            const float dr = 0.5f*(ar - br), di = 0.5f*(ai - bi);
+
+            // odd = difference / twiddle
+            const float wr = cosTable[(size_t) k], wi = -sinTable[(size_t) k];
+            const float orr = dr*wr - di*wi, oi = dr*wi + di*wr;
+
+            const int j = bitReverse[(size_t) k];
+            zr[(size_t) j] = er - oi;
+            zi[(size_t) j] = ei + orr;
+        }
+
+        transform (true);
+
+        for (int k = 0; k < half; ++k)
+        {
+            output[2*k] = zr[(size_t) k] * scale;
+            output[2*k + 1] = zi[(size_t) k] * scale;
+        }
+    }
+
+private:
+    // In place radix-2 on zr / zi, input already in bit-reversed order
+    void transform (bool inverse) noexcept
+    {
+        for (int size = 2; size <= half; size *= 2)
+        {
+            const int step = n / size;      // through the n point twiddle table
+
+            for (int start = 0; start < half; start += size)
+            {
+                for (int k = 0; k < size/2; ++k)
+                {
+                    const float wr = cosTable[(size_t) (k*step)];
+                    const float wi = inverse ? -sinTable[(size_t) (k*step)] : sinTable[(size_t) (k*step)];
+
+                    const size_t a = (size_t) (start + k), b = a + (size_t) size/2;
+                    const float tr = zr[b]*wr - zi[b]*wi;
+                    const float ti = zr[b]*wi + zi[b]*wr;
+
+                    zr[b] = zr[a] - tr;
+                    zi[b] = zi[a] - ti;
+                    zr[a] += tr;
+                    zi[a] += ti;
+                }
+            }
+        }
+    }
+
+    int n, half;
+    std::vector<int> bitReverse;
+    std::vector<float> cosTable, sinTable;
+    std::vector<float> zr, zi;
+};
+
+//==============================================================================
+class PartitionedConvolver
+{
+public:
+    static constexpr int PARTITION_SIZE = 64;       // also the latency
+    static constexpr int FFT_SIZE = 2*PARTITION_SIZE;
+    static constexpr int NUM_BINS = PARTITION_SIZE + 1;
+    static constexpr float MAX_LENGTH_MS = 1000.0f;
+
+    // Message thread: allocates. The IR, recorded at irSampleRate, is
+    // resampled to sampleRate (the rate the delay network runs at), cut at
+    // MAX_LENGTH_MS and scaled so that its gain peaks at exactly 1, so it
+    // colours the repeats without making the loop louder. An empty IR gives
+    // an empty convolver, which turns the slot back to the plain gain.
+    static std::unique_ptr<PartitionedConvolver> create (const float* ir, int numSamples, double irSampleRate, double sampleRate)
+    {
+        std::unique_ptr<PartitionedConvolver> convolver (new PartitionedConvolver (sampleRate));
+
+        if (ir == nullptr || numSamples <= 0 || irSampleRate <= 0 || sampleRate <= 0)
+            return convolver;
+
+        auto h = resample (ir, numSamples, irSampleRate, sampleRate);
+        h.resize (std::min (h.size(), (size_t) (MAX_LENGTH_MS/1000 * sampleRate)));
+
+        // Trailing silence would only cost partitions
+        while (! h.empty() && std::abs (h.back()) < 1.0e-6f)
+            h.pop_back();
+
+        const float peakGain = getPeakGain (h);
+        if (peakGain <= 0)
+            return convolver;
+
+        convolver->length = (int) h.size();
+        convolver->numPartitions = (convolver->length + PARTITION_SIZE - 1) / PARTITION_SIZE;
+
+        const size_t spectraSize = (size_t) (convolver->numPartitions * NUM_BINS);
+        convolver->kernelRe.assign (spectraSize, 0.0f);
+        convolver->kernelIm.assign (spectraSize, 0.0f);
+        convolver->historyRe.assign (spectraSize, 0.0f);
+        convolver->historyIm.assign (spectraSize, 0.0f);
+
+        float segment[FFT_SIZE];
+        for (int p = 0; p < convolver->numPartitions; ++p)
+        {
+            std::fill (segment, segment + FFT_SIZE, 0.0f);
+
+            for (int i = 0; i < PARTITION_SIZE && p*PARTITION_SIZE + i < convolver->length; ++i)
+                segment[i] = h[(size_t) (p*PARTITION_SIZE + i)] / peakGain;
+
+            convolver->fft.forward (segment, convolver->kernelRe.data() + p*NUM_BINS, convolver->kernelIm.data() + p*NUM_BINS);
+        }
+
+        return convolver;
+    }
+
+    // Length of the prepared IR, in samples at getSampleRate(). 0 when empty.
+    int getLength() const noexcept          { return length; }
+    double getSampleRate() const noexcept   { return sampleRate; }
+
+    // Audio thread from here on.
+    // Back to silence. Constant time: partitions are only read back once
+    // they have been written again.
+    void reset() noexcept
+    {
+        std::fill (std::begin (input), std::end (input), 0.0f);
+        std::fill (std::begin (output), std::end (output), 0.0f);
+        position = 0;
+        numFilled = 0;
+    }
+
+    // One sample in, one out, PARTITION_SIZE samples late
+    inline float process (float in) noexcept
+    {
+        input[PARTITION_SIZE + position] = in;
+        const float out = output[position];
+
+        if (++position == PARTITION_SIZE)
+        {
+            processPartition();
+            position = 0;
+        }
+
+        return out;
+    }
+
+    unsigned int serial = 0;        // set by ConvolutionSlot
+
+private:
+    explicit PartitionedConvolver (double rate) : sampleRate (rate), fft (FFT_SIZE) {}
+
+    void processPartition() noexcept
+    {
+        // Spectrum of the last two partitions of input into the history ring
+        float* const newestRe = historyRe.data() + head*NUM_BINS;
+        float* const newestIm = historyIm.data() + head*NUM_BINS;
+        fft.forward (input, newestRe, newestIm);
+
+        numFilled = std::min (numFilled + 1, numPartitions);
+
+        std::fill (std::begin (sumRe), std::end (sumRe), 0.0f);
+        std::fill (std::begin (sumIm), std::end (sumIm), 0.0f);
+
+        // Input partition (head - p) meets IR partition p
+        int slot = head;
+        for (int p = 0; p < numFilled; ++p)
+        {
+            const float* xr = historyRe.data() + slot*NUM_BINS;
+            const float* xi = historyIm.data() + slot*NUM_BINS;
+            const float* hr = kernelRe.data() + p*NUM_BINS;
+            const float* hi = kernelIm.data() + p*NUM_BINS;
+
+            for (int k = 0; k < NUM_BINS; ++k)
+            {
+                sumRe[k] += xr[k]*hr[k] - xi[k]*hi[k];
+                sumIm[k] += xr[k]*hi[k] + xi[k]*hr[k];
+            }
+
+            if (--slot < 0)
+                slot = numPartitions - 1;
+        }
+
+        // Overlap-save: the second half is the clean part of the circular result
+        float result[FFT_SIZE];
+        fft.inverse (sumRe, sumIm, result);
+        std::copy (result + PARTITION_SIZE, result + FFT_SIZE, output);
+
+        std::copy (input + PARTITION_SIZE, input + FFT_SIZE, input);
+
+        if (++head >= numPartitions)
+            head = 0;
+    }
+
+    // Windowed sinc, low-passed at the lower of the two Nyquists
+    static std::vector<float> resample (const float* x, int numSamples, double fromRate, double toRate)
+    {
+        if (std::abs (fromRate - toRate) < 1.0e-6 * toRate)
+            return std::vector<float> (x, x + numSamples);
+
+        const double ratio = toRate / fromRate;
+        const double cutoff = std::min (1.0, ratio);
+        const int halfWidth = (int) std::ceil (16 / cutoff);   // input samples either side
+
+        std::vector<float> y ((size_t) std::ceil (numSamples * ratio));
+
+        for (size_t n = 0; n < y.size(); ++n)
+        {
+            const double t = (double) n / ratio;
+            const int centre = (int) std::floor (t);
+            double sum = 0;
+
+            for (int k = std::max (0, centre - halfWidth + 1); k <= std::min (numSamples - 1, centre + halfWidth); ++k)
+            {
+                const double d = t - k;
+                const double u = d / halfWidth;
+                if (std::abs (u) >= 1)
+                    continue;
+
+                const double window = 0.42 + 0.5*std::cos (3.141592653589793*u) + 0.08*std::cos (2*3.141592653589793*u);
+                const double arg = 3.141592653589793 * cutoff * d;
+                const double sinc = d == 0 ? 1.0 : std::sin (arg) / arg;
+                sum += x[k] * cutoff * sinc * window;
+            }
+
+            y[n] = (float) sum;
+        }
+
+        return y;
+    }
+
+    // Largest magnitude of the frequency response, from a zero padded FFT
+    static float getPeakGain (const std::vector<float>& h)
+    {
+        if (h.empty())
+            return 0;
+
+        int n = 256;
+        while (n < 4 * (int) h.size())
+            n *= 2;
+
+        std::vector<float> padded ((size_t) n, 0.0f), re ((size_t) (n/2 + 1)), im ((size_t) (n/2 + 1));
+        std::copy (h.begin(), h.end(), padded.begin());
+
+        RealFft (n).forward (padded.data(), re.data(), im.data());
+
+        float peak = 0;
+        for (size_t k = 0; k < re.size(); ++k)
+            peak = std::max (peak, std::sqrt (re[k]*re[k] + im[k]*im[k]));
+
+        return peak;
+    }
+
+    double sampleRate;
+    int length = 0;
+    int numPartitions = 0;
+
+    RealFft fft;
+    std::vector<float> kernelRe, kernelIm;      // IR partition spectra
+    std::vector<float> historyRe, historyIm;    // input partition spectra, a ring
+
+    float input[FFT_SIZE] = {};
+    float output[PARTITION_SIZE] = {};
+    float sumRe[NUM_BINS] = {}, sumIm[NUM_BINS] = {};
+    int position = 0;
+    int head = 0;
+    int numFilled = 0;
+};
+
+//==============================================================================
+// One side's convolver as the engine sees it.
+//
+// The message thread posts prepared convolvers and owns them. The audio
+// thread takes the latest at the start of a block, and crossfades to it
+// from the one before (or the plain gain) while the new one fills up.
+// It publishes the serial number of the oldest convolver it still holds,
+// and collect() frees the ones before that, so nothing is freed in use and
+// the audio thread never waits.
+class ConvolutionSlot
+{
+public:
+    static constexpr int GATE_FADE_SAMPLES = 4*PartitionedConvolver::PARTITION_SIZE;
+
+    //==============================================================================
+    // Message thread (or whichever one thread sets the IRs)
+    void post (std::unique_ptr<PartitionedConvolver> next)
+    {
+        collect();
+
+        if (next == nullptr)
+            next = PartitionedConvolver::create (nullptr, 0, 1, 1);
+
+        next->serial = ++lastSerial;
+        auto* raw = next.get();
+        owned.push_back (std::move (next));
+
+        // One the audio thread never took can go straight away
+        if (auto* skipped = pending.exchange (raw, std::memory_order_acq_rel))
+            release (skipped);
+    }
+
+    void collect()
+    {
+        const unsigned int oldest = oldestInUse.load (std::memory_order_acquire);
+
+        owned.erase (std::remove_if (owned.begin(), owned.end(),
+                                     [oldest] (const std::unique_ptr<PartitionedConvolver>& c) { return c->serial < oldest; }),
+                     owned.end());
+    }
+
+    //==============================================================================
+    // Audio thread, once per block. delaySamples is the shortest delay the
+    // side's repeats have this block: the colouring is on while the IR is
+    // at least one partition shorter than it.
+    void update (double networkRate, float delaySamples) noexcept
+    {
+        if (previous == nullptr)
+        {
+            if (auto* next = pending.exchange (nullptr, std::memory_order_acq_rel))
+            {
+                next->reset();
+
+                // Crossfade from the old one while the new one fills up
+                if (! idle && isUsable (current, networkRate))
+                {
+                    previous = current;
+                    swapMix = 0;
+                    swapStep = 1.0f / (float) (next->getLength() + PartitionedConvolver::PARTITION_SIZE);
+                }
+
+                current = next;
+                publishInUse();
+            }
+        }
+
+        const int longest = std::max (isUsable (current, networkRate) ? current->getLength() : -1,
+                                      isUsable (previous, networkRate) ? previous->getLength() : -1);
+
+        gateOpen = longest >= 0 && (float) (longest + PartitionedConvolver::PARTITION_SIZE) <= delaySamples;
+        rate = networkRate;
+
+        if (idle && gateOpen)
+        {
+            // Fills up from silence: fade in over the time that takes
+            current->reset();
+            idle = false;
+            level = 0;
+            levelStep = 1.0f / (float) (longest + PartitionedConvolver::PARTITION_SIZE);
+        }
+        else if (! idle && ! gateOpen)
+        {
+            levelStep = 1.0f / GATE_FADE_SAMPLES;
+        }
+    }
+
+    // Whether process() has to run this block
+    bool isRunning() const noexcept { return ! idle; }
+
+    // in: the side's tap PARTITION_SIZE samples early. plain: the usual tap,
+    // returned as it is when the colouring is off.
+    inline float process (float in, float plain) noexcept
+    {
+        float coloured = run (current, in, plain);
+
+        if (previous != nullptr)
+        {
+            coloured = swapMix*coloured + (1 - swapMix)*run (previous, in, plain);
+
+            if ((swapMix += swapStep) >= 1.0f)
+            {
+                previous = nullptr;
+                publishInUse();
+            }
+        }
+
+        const float out = level*coloured + (1 - level)*plain;
+
+        if (gateOpen)
+            level = std::min (level + levelStep, 1.0f);
+        else if ((level -= levelStep) <= 0)
+            stop();
+
+        return out;
+    }
+
+    // The histories were cleared: so is whatever the convolvers hold
+    void reset() noexcept
+    {
+        if (current != nullptr)
+            stop();
+    }
+
+private:
+    bool isUsable (const PartitionedConvolver* c, double networkRate) const noexcept
+    {
+        // Prepared for another rate: wait for the owner to post one for this rate
+        return c != nullptr && c->getLength() > 0 && c->getSampleRate() == networkRate;
+    }
+
+    inline float run (PartitionedConvolver* c, float in, float plain) noexcept
+    {
+        return isUsable (c, rate) ? c->process (in) : plain;
+    }
+
+    void stop() noexcept
+    {
+        idle = true;
+        level = 0;
+
+        if (previous != nullptr)
+        {
+            previous = nullptr;
+            publishInUse();
+        }
+    }
+
+    void publishInUse() noexcept
+    {
+        oldestInUse.store (previous != nullptr ? previous->serial : current->serial, std::memory_order_release);
+    }
+
+    void release (PartitionedConvolver* c)
+    {
+        owned.erase (std::remove_if (owned.begin(), owned.end(),
+                                     [c] (const std::unique_ptr<PartitionedConvolver>& o) { return o.get() == c; }),
+                     owned.end());
+    }
+
+    // Message thread
+    std::vector<std::unique_ptr<PartitionedConvolver>> owned;
+    unsigned int lastSerial = 0;
+
+    std::atomic<PartitionedConvolver*> pending { nullptr };
+    std::atomic<unsigned int> oldestInUse { 0 };
+
+    // Audio thread
+    PartitionedConvolver* current = nullptr;
+    PartitionedConvolver* previous = nullptr;
+    float swapMix = 1, swapStep = 0;    // weight of current against previous
+    float level = 0, levelStep = 0;     // weight of the convolution against the plain gain
+    bool gateOpen = false;
+    bool idle = true;
+    double rate = 0;
+};
@@ -0,0 +1,286 @@
+/*
+  ==============================================================================
+
+    PingPongBatch.h
+    Many independent ping-pong delays advanced together, one per SIMD lane.
+
+    For hosts that run dozens of delays at once (a voice per game emitter),
+    running PingPongEngines one after the other leaves the vector units idle:
+    the per-sample network is scalar and serial. PingPongBatch<NumLanes>
+    keeps the state of 4, 8 or 16 instances in structure-of-arrays form and
+    runs the network for all of them in each step, so every line of the
+    per-sample loop is one vector operation across instances.
+
+    The delay histories are interleaved by lane: sample n of every instance
+    sits in one contiguous frame, so the writes are plain vector stores and
+    each tap read is a gather (every lane reads at its own delay). The taps,
+    the mix and the delay smoothing run through PingPongKernels, built for
+    each instruction set and picked at runtime.
+
+    Each lane has its own delay times, feedback, dry/wet and volume, with the
+    same smoothing and cubic taps as the engine's Jump mode. Time modes,
+    Freeze and reduced precision storage are per-engine features and are not
+    available here. All lanes share one sample rate and buffer size.
+
+    The engine's multiband mode runs its bands as the lanes of a batch laid
+    over its own delay memory; forget() starts that over in constant time.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include "PingPongParameters.h"
+#include "DelaySampleFormat.h"
+#include "PingPongKernels.h"
+
+//==============================================================================
+template <int NumLanes>
+class PingPongBatch
+{
+public:
+    static_assert (NumLanes == 4 || NumLanes == 8 || NumLanes == 16, "4, 8 or 16 lanes");
+
+    static constexpr int INIT_LATENCY = 8;      // write head lead over the read head, as in PingPongEngine
+
+    //==============================================================================
+    static size_t getLineStride (int bufferSize) noexcept
+    {
+        return (((size_t) bufferSize + DELAY_GUARD) * NumLanes * sizeof (float) + 63) & ~(size_t) 63;
+    }
+
+    static size_t getRequiredMemory (int bufferSize) noexcept
+    {
+        return 4 * getLineStride (bufferSize);
+    }
+
+    // getRequiredMemory (bufferSize) bytes, 64-byte aligned, zeroed
+    void setDelayMemory (void* memory, int newBufferSize) noexcept
+    {
+        delayMemory = memory;
+        bufferSize = newBufferSize;
+
+        const size_t stride = getLineStride (bufferSize);
+        for (int line = 0; line < 4; ++line)
+            lines[line] = memory != nullptr ? reinterpret_cast<float*> (static_cast<char*> (memory) + (size_t) line * stride) : nullptr;
+
+        writePointer = INIT_LATENCY;
+        readPointer = 0;
+    }
+
+    void clearDelayMemory() noexcept
+    {
+        if (delayMemory != nullptr)
+            std::memset (delayMemory, 0, getRequiredMemory (bufferSize));
+    }
+
+    int getBufferSize() const noexcept { return bufferSize; }
+
+    //==============================================================================
+    // Shared by all lanes. Smoothing starts from zero, the delay contents are kept.
+    void prepare (double sampleRate) noexcept
+    {
+        gSampleRate = (float) sampleRate;
+
+        for (int l = 0; l < NumLanes; ++l)
+        {
+            del_L_param_prev[l] = del_R_param_prev[l] = 0;
+            feedback_L_param_prev[l] = feedback_R_param_prev[l] = 0;
+            gDryWet_param_prev[l] = 0;
+        }
+    }
+
+    void reset() noexcept
+    {
+        prepare (gSampleRate);
+        clearDelayMemory();
+        writePointer = INIT_LATENCY;
+        readPointer = 0;
+
+        for (int l = 0; l < NumLanes; ++l)
+            crossSig_R_del_L[l] = crossSig_L_del_R[l] = 0;
+
+        written = bufferSize;
+    }
+
+    // Like reset(), but nothing is cleared: what the lines held reads as
+    // silence until it has been written over. Fine on the audio thread.
+    void forget() noexcept
+    {
+        prepare (gSampleRate);
+        writePointer = INIT_LATENCY;
+        readPointer = 0;
+        written = 0;
+
+        for (int l = 0; l < NumLanes; ++l)
+            crossSig_R_del_L[l] = crossSig_L_del_R[l] = 0;
+    }
+
+    // Delay times, feedback, dry/wet and volume of one instance
+    void setParameters (int lane, const PingPongParameters& p) noexcept
+    {
+        targetDel_L[lane] = p.delayL;
+        targetDel_R[lane] = p.delayR;
+        feedback_L_param[lane] = p.feedbackL;
+        feedback_R_param[lane] = p.feedbackR;
+        gDryWet_param[lane] = p.dryWet;
+        gVolume_param[lane] = p.volumeDb;
+    }
+
+    //==============================================================================
+    // In place: left[lane] / right[lane] are the buffers of each instance
+    void process (float* const* left, float* const* right, int numSamples) noexcept
+    {
+        const int size = bufferSize;
+        const float samplesPerMs = gSampleRate / 1000;
+        const PingPongKernels& kernels = getPingPongKernels();
+
+        // Volume isn't smoothed, so its gain is per block
+        alignas (64) float volume[NumLanes];
+        for (int l = 0; l < NumLanes; ++l)
+            volume[l] = std::pow (10.0f, gVolume_param[l] / 20);
+
+        alignas (64) float in_L[NumLanes], in_R[NumLanes];
+        alignas (64) int int_L[NumLanes], int_R[NumLanes];
+        alignas (64) float frac_L[NumLanes], frac_R[NumLanes];
+        alignas (64) float feedback_L[NumLanes], feedback_R[NumLanes];
+        alignas (64) float factDry[NumLanes], factWet[NumLanes];
+        alignas (64) float inSig_del[NumLanes], crossSig_L[NumLanes], crossSig_R[NumLanes];
+        alignas (64) float out_L[NumLanes], out_R[NumLanes];
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            // READ PARAMS (in double like the engine, so both settle on the same delay)
+            kernels.smooth (del_L_param_prev, targetDel_L, 0.99, NumLanes);
+            kernels.smooth (del_R_param_prev, targetDel_R, 0.99, NumLanes);
+
+            for (int l = 0; l < NumLanes; ++l)
+            {
+                in_L[l] = left[l][i];
+                in_R[l] = right[l][i];
+
+                // delays in samples, split for the cubic taps
+                const float d_L = del_L_param_prev[l]*samplesPerMs;
+                const float d_R = del_R_param_prev[l]*samplesPerMs;
+                int_L[l] = (int) d_L;
+                int_R[l] = (int) d_R;
+                frac_L[l] = d_L - (float) int_L[l];
+                frac_R[l] = d_R - (float) int_R[l];
+
+                feedback_L[l] = (1-0.8f)*feedback_L_param[l] + 0.8f*feedback_L_param_prev[l];
+                feedback_L_param_prev[l] = feedback_L_param[l];
+                feedback_R[l] = (1-0.8f)*feedback_R_param[l] + 0.8f*feedback_R_param_prev[l];
+                feedback_R_param_prev[l] = feedback_R_param[l];
+
+                const float gDryWet = (1-0.8f)*gDryWet_param[l] + 0.8f*gDryWet_param_prev[l];
+                gDryWet_param_prev[l] = gDryWet_param[l];
+
+                float drywet = 2*gDryWet - 1;
+                drywet = drywet < -1.0f ? -1.0f : (drywet > 0.99f ? 1.0f : drywet);
+
+                factDry[l] = std::sqrt (0.5f*(1.0f-drywet)) * volume[l];
+                factWet[l] = std::sqrt (0.5f*(1.0f+drywet)) * volume[l];
+            }
+
+            // Left: input history, then the cross-feedback from the right
+            writeFrame (0, writePointer, in_L);
+            readTaps (kernels, 0, int_L, frac_L, inSig_del);
+
+            for (int l = 0; l < NumLanes; ++l)
+                crossSig_L[l] = inSig_del[l] + feedback_L[l]*crossSig_R_del_L[l];
+
+            // Only the crossed taps feed anything; the engine's same-side
+            // crossSig reads are never used, so they are skipped here
+            writeFrame (2, writePointer, crossSig_L);
+            readTaps (kernels, 2, int_R, frac_R, crossSig_L_del_R);
+
+            // Right
+            writeFrame (1, writePointer, in_R);
+            readTaps (kernels, 1, int_R, frac_R, inSig_del);
+
+            for (int l = 0; l < NumLanes; ++l)
+                crossSig_R[l] = inSig_del[l] + feedback_R[l]*crossSig_L_del_R[l];
+
+            writeFrame (3, writePointer, crossSig_R);
+            readTaps (kernels, 3, int_L, frac_L, crossSig_R_del_L);
+
+            kernels.mix (in_L, crossSig_L, factWet, factDry, out_L, NumLanes);
+            kernels.mix (in_R, crossSig_R, factWet, factDry, out_R, NumLanes);
+
+            for (int l = 0; l < NumLanes; ++l)
+            {
+                left[l][i] = out_L[l];
+                right[l][i] = out_R[l];
+            }
+
+            if (++writePointer >= size)
+                writePointer = 0;
+            if (++readPointer >= size)
+                readPointer = 0;
+            if (written < size)
+                ++written;
+        }
+    }
+
+private:
+    //==============================================================================
+    void writeFrame (int line, int pos, const float* values) noexcept
+    {
+        float* frame = lines[line] + (size_t) pos * NumLanes;
+        std::memcpy (frame, values, sizeof (float) * NumLanes);
+
+        if (pos < DELAY_GUARD)
+            std::memcpy (frame + (size_t) bufferSize * NumLanes, values, sizeof (float) * NumLanes); // mirror into the guard
+    }
+
+    // Cubic Lagrange read for every lane at its own delay
+    void readTaps (const PingPongKernels& kernels, int line, const int* delaySamples, const float* alpha, float* dest) const noexcept
+    {
+        alignas (64) int index_m1[NumLanes];
+        for (int l = 0; l < NumLanes; ++l)
+        {
+            index_m1[l] = readPointer - delaySamples[l] - 1;
+            if (index_m1[l] < 0)
+                index_m1[l] += bufferSize;
+        }
+
+        // The guard keeps index_m1 + 3 in range
+        kernels.readTaps (lines[line], index_m1, alpha, dest, NumLanes);
+
+        // After forget(): taps reaching back past the first write are silent
+        if (written < bufferSize)
+            for (int l = 0; l < NumLanes; ++l)
+                if (delaySamples[l] + 1 + INIT_LATENCY > written)
+                    dest[l] = 0;
+    }
+
+    //==============================================================================
+    void* delayMemory = nullptr;
+    int bufferSize = 0;
+    float* lines[4] = {};   // inSig L/R, crossSig L/R, NumLanes floats per frame
+
+    int writePointer = INIT_LATENCY;
+    int readPointer = 0;
+    int written = 0;        // frames written since forget(), up to bufferSize
+
+    float gSampleRate = 44100;
+
+    alignas (64) float targetDel_L[NumLanes] = {};
+    alignas (64) float targetDel_R[NumLanes] = {};
+    alignas (64) float feedback_L_param[NumLanes] = {};
+    alignas (64) float feedback_R_param[NumLanes] = {};
+    alignas (64) float gDryWet_param[NumLanes] = {};
+    alignas (64) float gVolume_param[NumLanes] = {};
+
+    alignas (64) float del_L_param_prev[NumLanes] = {};
+    alignas (64) float del_R_param_prev[NumLanes] = {};
+    alignas (64) float feedback_L_param_prev[NumLanes] = {};
+    alignas (64) float feedback_R_param_prev[NumLanes] = {};
+    alignas (64) float gDryWet_param_prev[NumLanes] = {};
+
+    alignas (64) float crossSig_R_del_L[NumLanes] = {};
+    alignas (64) float crossSig_L_del_R[NumLanes] = {};
+};
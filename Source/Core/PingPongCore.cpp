@@ -0,0 +1,377 @@
+/*
+  ==============================================================================
+
+    PingPongCore.cpp
+
+  ==============================================================================
+*/
+
+#include "PingPongCore.h"
+#include "PingPongEngine.h"
+#include "PingPongBatch.h"
+
+#include <new>
+#include <cstdint>
+
+#if PINGPONG_USE_SSE2
+ #include <xmmintrin.h>
+#endif
+
+//==============================================================================
+// The caller's block holds the engine followed by its delay lines
+struct ppd_engine
+{
+    PingPongEngine engine;
+    float maxDelayMs;
+};
+
+static const size_t PPD_ALIGNMENT = 64;
+
+static size_t getHeaderSize()
+{
+    return (sizeof (ppd_engine) + PPD_ALIGNMENT - 1) & ~(PPD_ALIGNMENT - 1);
+}
+
+static int getBufferSize (double max_delay_ms, double sample_rate)
+{
+    return PingPongEngine::getBufferSizeFor ((int) std::ceil (max_delay_ms * sample_rate / 1000.0) + 1, sample_rate);
+}
+
+// Flushes denormals for the scope, like juce::ScopedNoDenormals in the plugin
+struct ScopedFlushDenormals
+{
+   #if PINGPONG_USE_SSE2
+    ScopedFlushDenormals() noexcept  : previous (_mm_getcsr())  { _mm_setcsr (previous | 0x8040); } // FTZ | DAZ
+    ~ScopedFlushDenormals() noexcept { _mm_setcsr (previous); }
+
+    unsigned int previous;
+   #endif
+};
+
+//==============================================================================
+size_t ppd_memory_size (double max_delay_ms, double sample_rate, ppd_format format)
+{
+    if (max_delay_ms < 0 || sample_rate <= 0)
+        return 0;
+
+    return getHeaderSize() + PingPongEngine::getRequiredMemory (getBufferSize (max_delay_ms, sample_rate), (DelaySampleFormat) format);
+}
+
+size_t ppd_memory_alignment (void)
+{
+    return PPD_ALIGNMENT;
+}
+
+ppd_engine* ppd_create (void* memory, size_t memory_size, double max_delay_ms, double sample_rate, ppd_format format)
+{
+    if (memory == nullptr || ((uintptr_t) memory & (PPD_ALIGNMENT - 1)) != 0
+         || format < PPD_FORMAT_FLOAT32 || format > PPD_FORMAT_INT16)
+        return nullptr;
+
+    const size_t required = ppd_memory_size (max_delay_ms, sample_rate, format);
+
+    if (required == 0 || memory_size < required)
+        return nullptr;
+
+    auto* e = new (memory) ppd_engine();
+    e->maxDelayMs = (float) max_delay_ms;
+
+    e->engine.setDelayMemory (static_cast<char*> (memory) + getHeaderSize(),
+                              getBufferSize (max_delay_ms, sample_rate), (DelaySampleFormat) format);
+    e->engine.prepare (sample_rate);
+    e->engine.reset();  // the caller's block needn't be zeroed, reset() masks it
+
+    return e;
+}
+
+void ppd_destroy (ppd_engine* engine)
+{
+    if (engine != nullptr)
+        engine->~ppd_engine();
+}
+
+void ppd_reset (ppd_engine* engine)
+{
+    engine->engine.reset();
+}
+
+void ppd_set_economy (ppd_engine* engine, int factor)
+{
+    engine->engine.setEconomyFactor (factor);
+}
+
+int ppd_get_wet_latency (const ppd_engine* engine)
+{
+    return engine->engine.getWetLatencySamples();
+}
+
+unsigned int ppd_get_guard_trips (const ppd_engine* engine)
+{
+    return engine->engine.getGuardTrips();
+}
+
+//==============================================================================
+void ppd_set_param (ppd_engine* engine, ppd_param param, float value)
+{
+    auto p = engine->engine.getParameters();
+
+    switch (param)
+    {
+        case PPD_PARAM_DELAY_L:     p.delayL = std::min (std::max (value, 0.0f), engine->maxDelayMs); break;
+        case PPD_PARAM_DELAY_R:     p.delayR = std::min (std::max (value, 0.0f), engine->maxDelayMs); break;
+        case PPD_PARAM_FEEDBACK_L:  p.feedbackL = value; break;
+        case PPD_PARAM_FEEDBACK_R:  p.feedbackR = value; break;
+        case PPD_PARAM_DRY_WET:     p.dryWet = value; break;
+        case PPD_PARAM_VOLUME:      p.volumeDb = value; break;
+        case PPD_PARAM_TIME_MODE:   p.timeMode = (DelayTimeMode) std::min (std::max ((int) value, 0), 2); break;
+        case PPD_PARAM_FADE_TIME:   p.fadeMs = value; break;
+        case PPD_PARAM_TAPE_RATE:   p.tapeRate = value; break;
+        case PPD_PARAM_FREEZE:      p.freeze = value > 0.5f; break;
+        case PPD_PARAM_SOFT_LIMIT:  p.softLimit = value > 0.5f; break;
+        case PPD_PARAM_QUALITY:     p.tapQuality = (TapQuality) std::min (std::max ((int) value, 0), 2); break;
+        case PPD_PARAM_FDN_LINES:   p.fdnLines = (int) value; break;
+        case PPD_PARAM_FDN_MATRIX:  p.fdnMatrix = (FeedbackMatrixType) std::min (std::max ((int) value, 0), 2); break;
+        case PPD_PARAM_DIFFUSION:   p.diffusion = std::min (std::max (value, 0.0f), 1.0f); break;
+        case PPD_PARAM_SHIMMER:     p.shimmer = std::min (std::max (value, 0.0f), 1.0f); break;
+        case PPD_PARAM_SHIMMER_INTERVAL: p.shimmerInterval = value > 0.5f ? ShimmerInterval::fifth : ShimmerInterval::octave; break;
+        case PPD_PARAM_REVERSE:     p.reverse = value > 0.5f; break;
+        case PPD_PARAM_BANDS:       p.bands = std::min (std::max ((int) value, 1), 3); break;
+        case PPD_PARAM_CROSSOVER_LOW:   p.crossoverLowHz = value; break;
+        case PPD_PARAM_CROSSOVER_HIGH:  p.crossoverHighHz = value; break;
+        case PPD_PARAM_BAND_DELAY_LOW:
+        case PPD_PARAM_BAND_DELAY_MID:
+        case PPD_PARAM_BAND_DELAY_HIGH:
+            p.bandDelayMs[param - PPD_PARAM_BAND_DELAY_LOW] = std::min (std::max (value, 0.0f), engine->maxDelayMs);
+            break;
+        case PPD_PARAM_BAND_FEEDBACK_LOW:
+        case PPD_PARAM_BAND_FEEDBACK_MID:
+        case PPD_PARAM_BAND_FEEDBACK_HIGH:
+            p.bandFeedback[param - PPD_PARAM_BAND_FEEDBACK_LOW] = value;
+            break;
+        case PPD_PARAM_DUCK_AMOUNT:     p.duckAmount = std::min (std::max (value, 0.0f), 1.0f); break;
+        case PPD_PARAM_DUCK_ATTACK:     p.duckAttackMs = std::max (value, 0.0f); break;
+        case PPD_PARAM_DUCK_RELEASE:    p.duckReleaseMs = std::max (value, 0.0f); break;
+        case PPD_PARAM_DUCK_THRESHOLD:  p.duckThresholdDb = value; break;
+        case PPD_PARAM_DRIVE:       p.drive = std::min (std::max (value, 0.0f), 1.0f); break;
+        default:                    return;
+    }
+
+    engine->engine.setParameters (p);
+}
+
+float ppd_get_param (const ppd_engine* engine, ppd_param param)
+{
+    const auto& p = engine->engine.getParameters();
+
+    switch (param)
+    {
+        case PPD_PARAM_DELAY_L:     return p.delayL;
+        case PPD_PARAM_DELAY_R:     return p.delayR;
+        case PPD_PARAM_FEEDBACK_L:  return p.feedbackL;
+        case PPD_PARAM_FEEDBACK_R:  return p.feedbackR;
+        case PPD_PARAM_DRY_WET:     return p.dryWet;
+        case PPD_PARAM_VOLUME:      return p.volumeDb;
+        case PPD_PARAM_TIME_MODE:   return (float) (int) p.timeMode;
+        case PPD_PARAM_FADE_TIME:   return p.fadeMs;
+        case PPD_PARAM_TAPE_RATE:   return p.tapeRate;
+        case PPD_PARAM_FREEZE:      return p.freeze ? 1.0f : 0.0f;
+        case PPD_PARAM_SOFT_LIMIT:  return p.softLimit ? 1.0f : 0.0f;
+        case PPD_PARAM_QUALITY:     return (float) (int) p.tapQuality;
+        case PPD_PARAM_FDN_LINES:   return (float) p.fdnLines;
+        case PPD_PARAM_FDN_MATRIX:  return (float) (int) p.fdnMatrix;
+        case PPD_PARAM_DIFFUSION:   return p.diffusion;
+        case PPD_PARAM_SHIMMER:     return p.shimmer;
+        case PPD_PARAM_SHIMMER_INTERVAL: return (float) (int) p.shimmerInterval;
+        case PPD_PARAM_REVERSE:     return p.reverse ? 1.0f : 0.0f;
+        case PPD_PARAM_BANDS:       return (float) p.bands;
+        case PPD_PARAM_CROSSOVER_LOW:   return p.crossoverLowHz;
+        case PPD_PARAM_CROSSOVER_HIGH:  return p.crossoverHighHz;
+        case PPD_PARAM_BAND_DELAY_LOW:
+        case PPD_PARAM_BAND_DELAY_MID:
+        case PPD_PARAM_BAND_DELAY_HIGH:     return p.bandDelayMs[param - PPD_PARAM_BAND_DELAY_LOW];
+        case PPD_PARAM_BAND_FEEDBACK_LOW:
+        case PPD_PARAM_BAND_FEEDBACK_MID:
+        case PPD_PARAM_BAND_FEEDBACK_HIGH:  return p.bandFeedback[param - PPD_PARAM_BAND_FEEDBACK_LOW];
+        case PPD_PARAM_DUCK_AMOUNT:     return p.duckAmount;
+        case PPD_PARAM_DUCK_ATTACK:     return p.duckAttackMs;
+        case PPD_PARAM_DUCK_RELEASE:    return p.duckReleaseMs;
+        case PPD_PARAM_DUCK_THRESHOLD:  return p.duckThresholdDb;
+        case PPD_PARAM_DRIVE:       return p.drive;
+        default:                    return 0;
+    }
+}
+
+int ppd_set_fdn_matrix (ppd_engine* engine, const float* rows, int size)
+{
+    return rows != nullptr && engine->engine.setUserFeedbackMatrix (rows, size) ? 1 : 0;
+}
+
+int ppd_set_ir (ppd_engine* engine, int side, const float* ir, int num_samples, double ir_sample_rate)
+{
+    if (side < 0 || side > 1)
+        return 0;
+
+    engine->engine.setConvolution (side, PartitionedConvolver::create (ir, num_samples, ir_sample_rate, engine->engine.getNetworkRate()));
+    return 1;
+}
+
+//==============================================================================
+void ppd_process (ppd_engine* engine, float* left, float* right, int num_frames)
+{
+    ScopedFlushDenormals noDenormals;
+    engine->engine.process (left, right, num_frames);
+}
+
+void ppd_process_interleaved (ppd_engine* engine, float* stereo, int num_frames)
+{
+    ScopedFlushDenormals noDenormals;
+    engine->engine.processInterleaved (stereo, num_frames);
+}
+
+void ppd_process_sidechain (ppd_engine* engine, float* left, float* right,
+                            const float* side_left, const float* side_right, int num_frames)
+{
+    ScopedFlushDenormals noDenormals;
+    engine->engine.setSidechain (side_left, side_right);
+    engine->engine.process (left, right, num_frames);
+}
+
+void ppd_process_bypassed (ppd_engine* engine, const float* left, const float* right, int num_frames)
+{
+    ScopedFlushDenormals noDenormals;
+    engine->engine.processBypassed (left, right, num_frames);
+}
+
+//==============================================================================
+struct ppd_batch
+{
+    int numLanes;
+    float maxDelayMs;
+    PingPongParameters params[16];
+
+    PingPongBatch<4> batch4;
+    PingPongBatch<8> batch8;
+    PingPongBatch<16> batch16;
+
+    template <typename Fn>
+    void withBatch (Fn&& fn)
+    {
+        switch (numLanes)
+        {
+            case 4:  fn (batch4); break;
+            case 8:  fn (batch8); break;
+            default: fn (batch16); break;
+        }
+    }
+};
+
+static size_t getBatchHeaderSize()
+{
+    return (sizeof (ppd_batch) + PPD_ALIGNMENT - 1) & ~(PPD_ALIGNMENT - 1);
+}
+
+static size_t getBatchLinesSize (int num_lanes, int bufferSize)
+{
+    switch (num_lanes)
+    {
+        case 4:  return PingPongBatch<4>::getRequiredMemory (bufferSize);
+        case 8:  return PingPongBatch<8>::getRequiredMemory (bufferSize);
+        case 16: return PingPongBatch<16>::getRequiredMemory (bufferSize);
+        default: return 0;
+    }
+}
+
+size_t ppd_batch_memory_size (int num_lanes, double max_delay_ms, double sample_rate)
+{
+    if (max_delay_ms < 0 || sample_rate <= 0)
+        return 0;
+
+    const size_t lines = getBatchLinesSize (num_lanes, getBufferSize (max_delay_ms, sample_rate));
+    return lines > 0 ? getBatchHeaderSize() + lines : 0;
+}
+
+ppd_batch* ppd_batch_create (void* memory, size_t memory_size, int num_lanes, double max_delay_ms, double sample_rate)
+{
+    if (memory == nullptr || ((uintptr_t) memory & (PPD_ALIGNMENT - 1)) != 0)
+        return nullptr;
+
+    const size_t required = ppd_batch_memory_size (num_lanes, max_delay_ms, sample_rate);
+
+    if (required == 0 || memory_size < required)
+        return nullptr;
+
+    auto* b = new (memory) ppd_batch();
+    b->numLanes = num_lanes;
+    b->maxDelayMs = (float) max_delay_ms;
+
+    void* lines = static_cast<char*> (memory) + getBatchHeaderSize();
+    const int bufferSize = getBufferSize (max_delay_ms, sample_rate);
+
+    b->withBatch ([&] (auto& batch)
+    {
+        batch.setDelayMemory (lines, bufferSize);
+        batch.prepare (sample_rate);
+        batch.reset();
+    });
+
+    return b;
+}
+
+void ppd_batch_destroy (ppd_batch* batch)
+{
+    if (batch != nullptr)
+        batch->~ppd_batch();
+}
+
+void ppd_batch_reset (ppd_batch* batch)
+{
+    batch->withBatch ([] (auto& b) { b.reset(); });
+}
+
+void ppd_batch_set_param (ppd_batch* batch, int lane, ppd_param param, float value)
+{
+    if (lane < 0 || lane >= batch->numLanes)
+        return;
+
+    auto& p = batch->params[lane];
+
+    switch (param)
+    {
+        case PPD_PARAM_DELAY_L:     p.delayL = std::min (std::max (value, 0.0f), batch->maxDelayMs); break;
+        case PPD_PARAM_DELAY_R:     p.delayR = std::min (std::max (value, 0.0f), batch->maxDelayMs); break;
+        case PPD_PARAM_FEEDBACK_L:  p.feedbackL = value; break;
+        case PPD_PARAM_FEEDBACK_R:  p.feedbackR = value; break;
+        case PPD_PARAM_DRY_WET:     p.dryWet = value; break;
+        case PPD_PARAM_VOLUME:      p.volumeDb = value; break;
+        default:                    return;
+    }
+
+    batch->withBatch ([&] (auto& b) { b.setParameters (lane, p); });
+}
+
+void ppd_batch_process (ppd_batch* batch, float* const* left, float* const* right, int num_frames)
+{
+    ScopedFlushDenormals noDenormals;
+    batch->withBatch ([&] (auto& b) { b.process (left, right, num_frames); });
+}
+
+//==============================================================================
+int ppd_get_simd_level (void)
+{
+    return (int) getPingPongKernels().level;
+}
+
+const char* ppd_get_simd_level_name (void)
+{
+    return getPingPongKernels().name;
+}
+
+int ppd_force_simd_level (int level)
+{
+    if (level < 0)
+        resetPingPongSimdLevel();
+    else
+        forcePingPongSimdLevel ((PingPongSimdLevel) std::min (level, (int) PingPongSimdLevel::avx512));
+
+    return ppd_get_simd_level();
+}
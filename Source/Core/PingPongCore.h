@@ -0,0 +1,178 @@
+/*
+  ==============================================================================
+
+    PingPongCore.h
+    Plain C interface to the ping-pong delay engine, for hosts that aren't
+    JUCE plugins (other plugin formats, games, embedded targets, bindings).
+
+    Build: compile PingPongCore.cpp and PingPongKernels.cpp (C++17) with Source/Core on the include
+    path, into the host or a static library. Nothing else is needed: the
+    core doesn't depend on JUCE.
+
+    Memory is supplied by the caller. Ask ppd_memory_size() how much one
+    engine needs, hand a block of that size aligned to ppd_memory_alignment()
+    to ppd_create(), and free it yourself after ppd_destroy(). Nothing in
+    here allocates except ppd_set_ir(), and ppd_process*() take no locks and
+    do no I/O.
+
+    Typical use:
+
+        size_t size = ppd_memory_size (2000.0, 48000.0, PPD_FORMAT_FLOAT32);
+        void* memory = aligned_alloc (ppd_memory_alignment(), size);
+        ppd_engine* delay = ppd_create (memory, size, 2000.0, 48000.0, PPD_FORMAT_FLOAT32);
+
+        ppd_set_param (delay, PPD_PARAM_DELAY_L, 375.0f);
+        ppd_process (delay, left, right, numFrames);     // in place
+
+        ppd_destroy (delay);
+        free (memory);
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//==============================================================================
+typedef struct ppd_engine ppd_engine;
+
+// Encoding of the delay histories, see DelaySampleFormat.h
+typedef enum
+{
+    PPD_FORMAT_FLOAT32 = 0,
+    PPD_FORMAT_FLOAT16,
+    PPD_FORMAT_INT16
+} ppd_format;
+
+typedef enum
+{
+    PPD_PARAM_DELAY_L = 0,  // ms, 0 .. the max delay given to ppd_create()
+    PPD_PARAM_DELAY_R,      // ms
+    PPD_PARAM_FEEDBACK_L,   // 0 .. 1
+    PPD_PARAM_FEEDBACK_R,   // 0 .. 1
+    PPD_PARAM_DRY_WET,      // 0 = dry .. 1 = wet
+    PPD_PARAM_VOLUME,       // dB
+    PPD_PARAM_TIME_MODE,    // 0 = jump, 1 = fade, 2 = tape
+    PPD_PARAM_FADE_TIME,    // ms
+    PPD_PARAM_TAPE_RATE,    // s of delay change per s
+    PPD_PARAM_FREEZE,       // 0 / 1
+    PPD_PARAM_SOFT_LIMIT,   // 0 / 1, soft limiter in the feedback path and on the output
+    PPD_PARAM_QUALITY,      // tap interpolation: 0 = linear, 1 = cubic, 2 = sinc (offline)
+    PPD_PARAM_FDN_LINES,    // 2 = ping-pong, 4 / 8 / 16 = feedback delay network
+    PPD_PARAM_FDN_MATRIX,   // FDN mixing: 0 = Hadamard, 1 = Householder, 2 = user (ppd_set_fdn_matrix)
+    PPD_PARAM_DIFFUSION,    // 0 .. 1, allpass smearing of the repeats (ping-pong, delays of 25 ms and up)
+    PPD_PARAM_SHIMMER,      // 0 .. 1, share of the feedback pitched up (ping-pong, delays of 20 ms and up)
+    PPD_PARAM_SHIMMER_INTERVAL, // 0 = octave, 1 = fifth
+    PPD_PARAM_REVERSE,      // 0 / 1, the input played backwards a delay-length segment at a time (ping-pong)
+    PPD_PARAM_BANDS,        // 1 = off, 2 / 3 = multiband ping-pong (bands hold 1/4 of the max delay, less with 16-bit formats)
+    PPD_PARAM_CROSSOVER_LOW,    // Hz, low / high crossover
+    PPD_PARAM_CROSSOVER_HIGH,   // Hz, 3 bands only
+    PPD_PARAM_BAND_DELAY_LOW,   // ms, both sides of the band
+    PPD_PARAM_BAND_DELAY_MID,   // ms, 3 bands only
+    PPD_PARAM_BAND_DELAY_HIGH,  // ms
+    PPD_PARAM_BAND_FEEDBACK_LOW,    // 0 .. 1
+    PPD_PARAM_BAND_FEEDBACK_MID,    // 0 .. 1, 3 bands only
+    PPD_PARAM_BAND_FEEDBACK_HIGH,   // 0 .. 1
+    PPD_PARAM_DUCK_AMOUNT,      // 0 .. 1, how far the repeats go down under the sidechain (ppd_process_sidechain)
+    PPD_PARAM_DUCK_ATTACK,      // ms
+    PPD_PARAM_DUCK_RELEASE,     // ms
+    PPD_PARAM_DUCK_THRESHOLD,   // dB, sidechain peak level where ducking starts
+    PPD_PARAM_DRIVE,        // 0 .. 1, saturation in the ping-pong's feedback path (oversampled at quality 2)
+    PPD_NUM_PARAMS
+} ppd_param;
+
+//==============================================================================
+size_t ppd_memory_size (double max_delay_ms, double sample_rate, ppd_format format);
+size_t ppd_memory_alignment (void);
+
+// Returns NULL if the memory is too small or misaligned. The delay lines start
+// out silent. To change the rate or max delay, destroy and create again.
+ppd_engine* ppd_create (void* memory, size_t memory_size, double max_delay_ms, double sample_rate, ppd_format format);
+void ppd_destroy (ppd_engine* engine);
+
+// Back to silence, in constant time: the state and parameter smoothing start
+// over, and the delay lines read as silence from here on. Nothing is zeroed
+// up front; reads of the old contents are masked until the write heads have
+// gone round, and the stale stretch left ahead of them is zeroed just before
+// they wrap. Cheap enough to call from the audio thread.
+void ppd_reset (ppd_engine* engine);
+
+// Economy mode: 1 = full rate, 2 or 4 runs the delay network at 1/2 or 1/4 of
+// the sample rate (the dry signal stays at full rate). Clears the delay lines.
+// The memory and max delay given to ppd_create() still apply.
+void ppd_set_economy (ppd_engine* engine, int factor);
+
+// How many samples late the repeats are because of Economy mode's filters
+int ppd_get_wet_latency (const ppd_engine* engine);
+
+// How many blocks came out NaN, infinite or runaway loud, and had the delay
+// lines cleared and the block muted. Any thread.
+unsigned int ppd_get_guard_trips (const ppd_engine* engine);
+
+// Takes effect from the next ppd_process*() call; call from the same thread
+void ppd_set_param (ppd_engine* engine, ppd_param param, float value);
+float ppd_get_param (const ppd_engine* engine, ppd_param param);
+
+// The user FDN matrix, size * size values row by row, size 4, 8 or 16. The
+// rows are orthonormalised so the loop stays stable. Returns 0 for a bad
+// size. From the processing thread, between ppd_process*() calls.
+int ppd_set_fdn_matrix (ppd_engine* engine, const float* rows, int size);
+
+// An impulse response that colours each repeat of one side (0 = L, 1 = R),
+// e.g. a tape head, speaker or spring; the side's feedback still sets how
+// fast they decay. It is resampled, cut at 1 s and normalised to a peak
+// gain of 1, and used while it is at least 64 samples (one convolution
+// partition) shorter than the side's delay. NULL or 0 samples removes it. Allocates and does the FFT
+// work on the calling thread, which must not be the processing thread; the
+// swap happens at the start of the next ppd_process*() call. Call again
+// after ppd_set_economy(). Returns 0 for a bad side.
+int ppd_set_ir (ppd_engine* engine, int side, const float* ir, int num_samples, double ir_sample_rate);
+
+// In place. Denormals are flushed to zero for the duration of the call.
+void ppd_process (ppd_engine* engine, float* left, float* right, int num_frames);
+void ppd_process_interleaved (ppd_engine* engine, float* stereo, int num_frames);
+
+// ppd_process() with a sidechain that ducks the repeats (PPD_PARAM_DUCK_*).
+// side_right may be NULL for a mono sidechain, both NULL for none.
+void ppd_process_sidechain (ppd_engine* engine, float* left, float* right,
+                            const float* side_left, const float* side_right, int num_frames);
+
+// For when the host bypasses the effect: the audio is left untouched, but the
+// delay keeps running on it, so ppd_process() afterwards carries on in step.
+void ppd_process_bypassed (ppd_engine* engine, const float* left, const float* right, int num_frames);
+
+//==============================================================================
+// Batches of 4, 8 or 16 independent delays processed together, one per SIMD
+// lane (see PingPongBatch.h). Same memory rules as above. Only the delay,
+// feedback, dry/wet and volume parameters apply; lanes run in jump mode.
+typedef struct ppd_batch ppd_batch;
+
+size_t ppd_batch_memory_size (int num_lanes, double max_delay_ms, double sample_rate);
+
+ppd_batch* ppd_batch_create (void* memory, size_t memory_size, int num_lanes, double max_delay_ms, double sample_rate);
+void ppd_batch_destroy (ppd_batch* batch);
+void ppd_batch_reset (ppd_batch* batch);
+
+void ppd_batch_set_param (ppd_batch* batch, int lane, ppd_param param, float value);
+
+// In place. left[lane] / right[lane] hold num_frames samples of each instance.
+void ppd_batch_process (ppd_batch* batch, float* const* left, float* const* right, int num_frames);
+
+//==============================================================================
+// Instruction set used by the batch kernels (see PingPongKernels.h):
+// 0 = baseline (SSE2 on x86), 1 = AVX2, 2 = AVX-512.
+int ppd_get_simd_level (void);
+const char* ppd_get_simd_level_name (void);
+
+// Forces a level (clamped to what the CPU supports), or -1 for automatic.
+// Returns the level in use afterwards. Not while processing.
+int ppd_force_simd_level (int level);
+
+#ifdef __cplusplus
+}
+#endif
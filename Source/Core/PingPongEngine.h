@@ -0,0 +1,2086 @@
+/*
+  ==============================================================================
+
+    PingPongEngine.h
+    The ping-pong delay DSP, independent of JUCE.
+
+    Everything that runs per sample lives here: the two input histories, the
+    two cross-feedback histories, the cubic taps, the delay time modes and
+    Freeze. The plugin is a thin wrapper around one engine, and the plain C
+    API in PingPongCore.h exposes the same engine to other hosts.
+
+    The engine never allocates. The caller hands it one block of memory for
+    the delay histories (getRequiredMemory() bytes, 64-byte aligned, zeroed)
+    and keeps it alive for as long as the engine uses it. Processing is in
+    place on deinterleaved or interleaved stereo float buffers.
+
+    Delay lines can also come from elsewhere: process() is templated on a
+    lines accessor, see RamDelayLines below for what it has to provide.
+
+    In Economy mode the network (histories, taps, time modes, Freeze) runs at
+    1/2 or 1/4 of the host rate between half-band decimators / interpolators,
+    and only the dry/wet mix runs at full rate. Delay memory and per-sample
+    cost of the network go down by the factor; the repeats lose the top of
+    the spectrum and arrive getWetLatencySamples() late.
+
+    Every block ends with an output guard: one SIMD peak scan of the output.
+    A NaN, an infinity or a runaway level clears the histories and mutes the
+    block, instead of letting it recirculate forever. The optional soft
+    limiter bends the feedback path and the output under a ceiling; below
+    its knee it costs a compare per sample in the network and nothing on the
+    output.
+
+    FDN mode replaces the ping-pong with a feedback delay network of 4, 8
+    or 16 lines, mixed through an orthogonal matrix (FeedbackMatrix.h) and
+    spread over the same delay memory, so each line holds 4/N of a history.
+    Even lines are the left side, around Delay L with Feedback L, odd ones
+    the right. Line lengths are whole samples, spread geometrically over
+    up to a fifth (x1.5) above each side's delay, and jump when it changes
+    (the time modes are for the ping-pong taps). Freeze makes the loop
+    lossless and stops the input. Two lines is the ping-pong itself.
+
+    Each side of the ping-pong can colour its repeats with a short impulse
+    response (PartitionedConvolver.h), applied to the tap ahead of the
+    side's feedback gain, which still sets the decay. The convolvers are prepared off the audio thread and swapped in
+    between blocks; their one partition of latency is taken off the tap
+    that feeds them.
+
+    Diffusion runs both sides' repeats through a cascade of nested allpasses
+    (AllpassDiffuser.h), L and R in the lanes of one SIMD register, so the
+    echoes smear a little more on every trip round the loop. Its latency is
+    taken off the taps the same way; at Diffusion 0 it is out of the loop.
+
+    Shimmer pitches the ping-pong's repeats up an octave or a fifth on each
+    trip round (ShimmerHeads.h). It reads them with two more heads moving
+    through the same cross-feedback histories, so it needs no memory of its
+    own, and at Shimmer 0 the taps are read as before.
+
+    Reverse plays each side's input history backwards, a delay-length
+    segment at a time with crossfaded boundaries (ReversePlayback.h), into
+    the ping-pong in place of the forward input tap. The segments are read
+    a chunk at a time as reversed bulk copies, so it costs no more than the
+    tap it replaces.
+
+    Drive saturates what the ping-pong writes back into its cross-feedback
+    histories (FeedbackSaturator.h), so the repeats squash more the higher
+    the feedback. The clipper is antialiased with its antiderivative, and
+    runs oversampled with the sinc taps; its latency (half a sample, or
+    about 11 oversampled) is taken off the input tap and the repeats'
+    taps alike, so the first echo and the loop keep their timing. Delays
+    shorter than that latency, and Reverse's backwards segments, come
+    out that much late. The early taps are worked out once per block while
+    the delay times and the drive level are at rest, so a settled Drive
+    costs the two clippers (about 20% on top of the cubic ping-pong).
+    At Drive 0 it is out of the loop.
+
+    Multiband splits the input with a Linkwitz-Riley crossover
+    (CrossoverFilterbank.h) into 2 or 3 bands, each its own ping-pong with
+    its own delay and feedback, run side by side as the lanes of a
+    PingPongBatch laid over the delay memory (each band gets a quarter of
+    it, like a 16-line FDN's lines), and sums their repeats. Only the
+    output mix and the output guard of the engine apply to it; it replaces
+    the ping-pong, not the FDN, and runs on the RAM buffers.
+
+    Ducking turns the echoes down under a sidechain (SidechainDucker.h),
+    given per block with setSidechain(). Its gain curve is worked out a
+    chunk at a time from block peaks of the sidechain and applied by the
+    output mix of whichever network runs, at the host rate; the input the
+    wet side carries is left alone. Without a sidechain nothing changes.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <atomic>
+#include "PingPongParameters.h"
+#include "DelaySampleFormat.h"
+#include "HalfBandFilter.h"
+#include "PartitionedConvolver.h"
+#include "AllpassDiffuser.h"
+#include "ReversePlayback.h"
+#include "CrossoverFilterbank.h"
+#include "PingPongBatch.h"
+#include "SidechainDucker.h"
+#include "FeedbackSaturator.h"
+#include "PingPongKernels.h"
+
+//==============================================================================
+// Delay line accessor over the RAM buffers, in one of the DelaySampleFormat
+// encodings. Lines 0/1 are the input histories (L/R), lines 2/3 the
+// cross-feedback histories (L/R). The guard samples past the end of each
+// buffer make the 4 points of a cubic read contiguous even across the wrap,
+// so they can be decoded in one go.
+template <typename Format>
+struct RamDelayLines
+{
+    typename Format::Stored* lines[4];
+    int size;
+
+    int getSize() const noexcept { return size; }
+
+    void write (int line, int pos, float value) const noexcept
+    {
+        auto stored = Format::encode (value);
+        lines[line][pos] = stored;
+
+        if (pos < DELAY_GUARD)
+            lines[line][pos + size] = stored; // mirror into the guard
+    }
+
+    void read4 (int line, int start, float* dest) const noexcept
+    {
+        Format::load4 (lines[line] + start, dest);
+    }
+
+    float read (int line, int pos) const noexcept { return Format::decode (lines[line][pos]); }
+
+    // count samples going back from pos (wrapping): dest[k] is the one at pos - k
+    void readBackwards (int line, int pos, int count, float* dest) const noexcept
+    {
+        while (count > 0)
+        {
+            const int run = std::min (count, pos + 1);
+            loadReversed<Format> (lines[line] + pos + 1 - run, run, dest);
+
+            dest += run;
+            count -= run;
+            pos = size - 1;
+        }
+    }
+};
+
+//==============================================================================
+class PingPongEngine
+{
+public:
+    static constexpr int INIT_LATENCY = 8;          // write head lead over the read head
+    static constexpr int MULTIBAND_LANES = 4;       // bands, padded to a SIMD width
+    static_assert (PingPongBatch<MULTIBAND_LANES>::INIT_LATENCY == INIT_LATENCY, "the bands' heads run like the ping-pong's");
+    static constexpr float FREEZE_SEAM_MS = 20.0f;
+    static constexpr float TAPE_SETTLE_MS = 50.0f;
+    static constexpr float QUALITY_FADE_MS = 20.0f;     // crossfade between tap interpolation orders
+    static constexpr int DIFFUSION_FADE_SAMPLES = 256;  // Diffusion going to 0, or not fitting the delay
+    static constexpr int SHIMMER_FADE_SAMPLES = 512;    // Shimmer changing, or not fitting the delay
+    static constexpr int REVERSE_FADE_SAMPLES = 512;    // Reverse switched on or off
+    static constexpr int DRIVE_FADE_SAMPLES = 512;      // Drive switched on or off, or oversampling changing
+
+    // Output guard and soft limiter levels (linear, 1 = full scale)
+    static constexpr float RUNAWAY_LEVEL = 1000.0f;     // +60 dB: the network has blown up
+    static constexpr float OUTPUT_KNEE = 0.9f;
+    static constexpr float OUTPUT_CEILING = 1.0f;
+    static constexpr float FEEDBACK_KNEE = 1.0f;
+    static constexpr float FEEDBACK_CEILING = 2.0f;
+
+    //==============================================================================
+    static size_t getStoredSampleSize (DelaySampleFormat format) noexcept
+    {
+        switch (format)
+        {
+            case DelaySampleFormat::float16: return sizeof (Float16Storage::Stored);
+            case DelaySampleFormat::int16:   return sizeof (Int16Storage::Stored);
+            default:                         return sizeof (Float32Storage::Stored);
+        }
+    }
+
+    // Each of the four buffers is DELAY_GUARD samples longer than bufferSize,
+    // rounded up to keep them 64-byte aligned.
+    static size_t getLineStride (int bufferSize, DelaySampleFormat format) noexcept
+    {
+        return (((size_t) bufferSize + DELAY_GUARD) * getStoredSampleSize (format) + 63) & ~(size_t) 63;
+    }
+
+    static size_t getRequiredMemory (int bufferSize, DelaySampleFormat format) noexcept
+    {
+        return 4 * getLineStride (bufferSize, format);
+    }
+
+    // Smallest buffer that holds maxDelaySamples plus the write head lead and
+    // the taps' interpolation points, and leaves Freeze room for its loop.
+    static int getBufferSizeFor (int maxDelaySamples, double sampleRate) noexcept
+    {
+        const int seam = getFreezeSeamSamples (sampleRate);
+        return std::max (maxDelaySamples + INIT_LATENCY + 4, 5 * seam + INIT_LATENCY);
+    }
+
+    //==============================================================================
+    // Points the engine at its delay memory (getRequiredMemory (bufferSize, format)
+    // bytes, 64-byte aligned). Expected zeroed: call reset() (or clearDelayMemory())
+    // if it isn't.
+    // The read / write heads restart, the rest of the state is kept.
+    void setDelayMemory (void* memory, int newBufferSize, DelaySampleFormat format) noexcept
+    {
+        delayMemory = memory;
+        bufferSize = newBufferSize;
+        delayStorageFormat = format;
+
+        const size_t stride = getLineStride (bufferSize, format);
+        auto* base = static_cast<char*> (memory);
+
+        for (int i = 0; i < 2; ++i) // 2 channels
+        {
+            gDelayBuffer_inSig[i] = memory != nullptr ? base + (size_t) i * stride : nullptr;
+            gDelayBuffer_crossSig[i] = memory != nullptr ? base + (size_t) (2 + i) * stride : nullptr;
+        }
+
+        // Multiband lays itself out again on the next block
+        bands = 1;
+
+        resetPointers();
+    }
+
+    void clearDelayMemory() noexcept
+    {
+        if (delayMemory != nullptr)
+            std::memset (delayMemory, 0, getRequiredMemory (bufferSize, delayStorageFormat));
+    }
+
+    bool hasDelayMemory() const noexcept             { return delayMemory != nullptr; }
+    int getBufferSize() const noexcept               { return bufferSize; }
+    DelaySampleFormat getDelayStorageFormat() const noexcept { return delayStorageFormat; }
+
+    // Longest delay the RAM buffers can hold at the prepared rate
+    float getMaxDelayMs() const noexcept
+    {
+        return (float) (bufferSize - INIT_LATENCY - 4) * 1000.0f / networkRate;
+    }
+
+    //==============================================================================
+    // Economy: 1 (full rate), 2 or 4. The delay buffers hold factor times as
+    // long, so a host can give the engine that much less memory. Starts over
+    // like reset(); not while processing.
+    void setEconomyFactor (int factor) noexcept
+    {
+        economyFactor = factor >= 4 ? 4 : (factor >= 2 ? 2 : 1);
+        reset();
+    }
+
+    int getEconomyFactor() const noexcept { return economyFactor; }
+
+    // How much later than at full rate the repeats arrive, in host samples:
+    // the filters, plus the network's own INIT_LATENCY - 2 sample offset
+    // between write and read head, which now counts in low rate samples
+    static int getWetLatencySamples (int factor) noexcept
+    {
+        int filters = 0;
+
+        if (factor == 2)
+            filters = HalfBandDecimator::LATENCY + HalfBandInterpolator::LATENCY;
+        else if (factor == 4)
+            filters = HalfBandDecimator::LATENCY + 2*HalfBandDecimator::LATENCY
+                    + 2*HalfBandInterpolator::LATENCY + HalfBandInterpolator::LATENCY;
+
+        return filters + (factor - 1) * (INIT_LATENCY - 2);
+    }
+
+    int getWetLatencySamples() const noexcept { return getWetLatencySamples (economyFactor); }
+
+    //==============================================================================
+    // Starts the parameter smoothing and the time modes from zero and leaves
+    // Freeze, like a fresh start of playback. The delay contents are kept.
+    void prepare (double sampleRate) noexcept
+    {
+        gSampleRate = (float) sampleRate;
+        T = 1 / gSampleRate;
+        networkRate = gSampleRate / (float) economyFactor;
+
+        del_L_param_prev = 0;
+        del_R_param_prev = 0;
+        feedback_L_param_prev = 0;
+        feedback_R_param_prev = 0;
+        gDryWet_param_prev = 0;
+
+        delayTimeFade_L.reset (0);
+        delayTimeFade_R.reset (0);
+        tapeSlew_L.reset (0);
+        tapeSlew_R.reset (0);
+
+        // Freeze: seam / transition crossfade length
+        freezeSeamSamples = getFreezeSeamSamples (networkRate);
+        freezeFadeRemaining = 0;
+        isFrozen = false;
+
+        // Built here rather than on the audio thread
+        HalfBandCoefficients::get();
+        SincTable::get();
+
+        tapInterpolator.reset (params.tapQuality);
+        diffuser.prepare (networkRate);
+        bandBatch.prepare (networkRate);
+        shimmerHeads.prepare (networkRate);
+        reversePlayback[0].prepare (networkRate);
+        reversePlayback[1].prepare (networkRate);
+        ducker.prepare (gSampleRate);
+
+        resetRateConverters();
+    }
+
+    // Everything back to silence, in constant time: the state starts over like
+    // prepare(), and whatever the histories held reads as silence from here on.
+    // Nothing is cleared up front; the writes overwrite it as the heads go
+    // round, and the last stretch is zeroed just before they wrap. Fine on the
+    // audio thread, for any line storage.
+    void reset() noexcept
+    {
+        prepare (gSampleRate);
+        forgetHistories();
+    }
+
+    // How many times the output guard has cleared the network. Any thread.
+    unsigned int getGuardTrips() const noexcept { return guardTrips.load (std::memory_order_relaxed); }
+
+    // Interpolation order the taps are using (or fading to)
+    TapQuality getTapQuality() const noexcept { return tapInterpolator.quality; }
+
+    // FDN mode: the matrix for FeedbackMatrixType::user, row by row (see
+    // UserFeedbackMatrix). Until one of the network's size is set, user falls
+    // back to Hadamard. Not while processing.
+    bool setUserFeedbackMatrix (const float* rows, int size) noexcept { return userFeedbackMatrix.set (rows, size); }
+
+    // Lines in the network: 2 for the ping-pong, 4, 8 or 16 in FDN mode
+    int getNetworkLines() const noexcept { return fdnLines; }
+
+    // Bands the ping-pong is split into: 1, or 2 / 3 in multiband mode
+    int getNumBands() const noexcept { return bands; }
+
+    // Longest delay of a band in multiband mode
+    float getMaxBandDelayMs() const noexcept
+    {
+        return (float) (getBandBufferSize() - INIT_LATENCY - 4) * 1000.0f / networkRate;
+    }
+
+    // The sidechain for the next process() call, numSamples long like the
+    // block; right may be nullptr for a mono one. Without it there is no
+    // ducking (an ongoing one releases).
+    void setSidechain (const float* left, const float* right) noexcept
+    {
+        sidechain[0] = left;
+        sidechain[1] = left != nullptr ? right : nullptr;
+    }
+
+    void setParameters (const PingPongParameters& newParams) noexcept { params = newParams; }
+    const PingPongParameters& getParameters() const noexcept          { return params; }
+
+    double getSampleRate() const noexcept { return gSampleRate; }
+
+    // The rate the delay network runs at: the sample rate over the Economy factor
+    double getNetworkRate() const noexcept { return networkRate; }
+
+    // The IR colouring the repeats of one side (0 = L, 1 = R), made by
+    // PartitionedConvolver::create() for getNetworkRate(); nullptr goes back
+    // to the plain repeats. The feedback gain applies either way. Takes effect from the next block, with a
+    // crossfade. From one thread other than the audio thread, which also
+    // frees the convolvers the engine is done with on the next call.
+    void setConvolution (int side, std::unique_ptr<PartitionedConvolver> convolver)
+    {
+        convolution[side & 1].post (std::move (convolver));
+    }
+
+    //==============================================================================
+    // In place, on the RAM buffers
+    void process (float* left, float* right, int numSamples) noexcept
+    {
+        // The per-sample network is the same for every storage format, only the
+        // encode/decode of the delay histories differs (float16 with F16C where
+        // the CPU has it).
+        switch (delayStorageFormat)
+        {
+            case DelaySampleFormat::float16:
+               #if PINGPONG_USE_F16C
+                if (getPingPongKernels().f16c)
+                {
+                    process (left, right, numSamples, makeRamDelayLines<Float16F16CStorage>());
+                    break;
+                }
+               #endif
+                process (left, right, numSamples, makeRamDelayLines<Float16Storage>());
+                break;
+
+            case DelaySampleFormat::int16:   process (left, right, numSamples, makeRamDelayLines<Int16Storage>());   break;
+            default:                         process (left, right, numSamples, makeRamDelayLines<Float32Storage>()); break;
+        }
+    }
+
+    // Host bypass, on the RAM buffers
+    void processBypassed (const float* left, const float* right, int numSamples) noexcept
+    {
+        switch (delayStorageFormat)
+        {
+            case DelaySampleFormat::float16:
+               #if PINGPONG_USE_F16C
+                if (getPingPongKernels().f16c)
+                {
+                    processBypassed (left, right, numSamples, makeRamDelayLines<Float16F16CStorage>());
+                    break;
+                }
+               #endif
+                processBypassed (left, right, numSamples, makeRamDelayLines<Float16Storage>());
+                break;
+
+            case DelaySampleFormat::int16:   processBypassed (left, right, numSamples, makeRamDelayLines<Int16Storage>());   break;
+            default:                         processBypassed (left, right, numSamples, makeRamDelayLines<Float32Storage>()); break;
+        }
+    }
+
+    // In place, on interleaved stereo
+    void processInterleaved (float* stereo, int numFrames) noexcept
+    {
+        sidechain[0] = sidechain[1] = nullptr;     // only for deinterleaved blocks
+
+        float left[CHUNK_SIZE], right[CHUNK_SIZE];
+
+        for (int start = 0; start < numFrames; start += CHUNK_SIZE)
+        {
+            const int n = std::min (CHUNK_SIZE, numFrames - start);
+            float* frames = stereo + 2 * start;
+
+            for (int i = 0; i < n; ++i)
+            {
+                left[i] = frames[2 * i];
+                right[i] = frames[2 * i + 1];
+            }
+
+            process (left, right, n);
+
+            for (int i = 0; i < n; ++i)
+            {
+                frames[2 * i] = left[i];
+                frames[2 * i + 1] = right[i];
+            }
+        }
+    }
+
+    template <typename Lines>
+    void process (float* left, float* right, int numSamples, const Lines& lines) noexcept
+    {
+        processLines<false> (left, right, numSamples, lines);
+        sidechain[0] = sidechain[1] = nullptr;
+    }
+
+    // Host bypass: the audio is left as it is, but the network keeps running on
+    // it (its output thrown away), so when bypass ends the repeats carry on from
+    // where they would be by now instead of replaying stale histories.
+    template <typename Lines>
+    void processBypassed (const float* left, const float* right, int numSamples, const Lines& lines) noexcept
+    {
+        sidechain[0] = sidechain[1] = nullptr;
+
+        float scratchL[CHUNK_SIZE], scratchR[CHUNK_SIZE];
+
+        for (int start = 0; start < numSamples; start += CHUNK_SIZE)
+        {
+            const int n = std::min (CHUNK_SIZE, numSamples - start);
+
+            std::copy (left + start, left + start + n, scratchL);
+            std::copy (right + start, right + start + n, scratchR);
+
+            processLines<true> (scratchL, scratchR, n, lines);
+        }
+    }
+
+    //==============================================================================
+    // For storage that prepares lines ahead of use: the write position and how
+    // far back the taps (and a frozen loop with its seam pre-roll) reach.
+    int getWritePosition() const noexcept { return gWritePointer_inSig[0]; }
+
+    void getTapReach (int (&tapDelays)[2]) const noexcept
+    {
+        int reach_R = (int) (del_R*networkRate/1000);
+        if (isFrozen || freezeFadeRemaining > 0)
+            reach_R = std::max (reach_R, freezeLoopLength + freezeSeamSamples);
+
+        tapDelays[0] = (int) (del_L*networkRate/1000);
+        tapDelays[1] = reach_R;
+    }
+
+private:
+    //==============================================================================
+    // Bypassed only needs the histories kept going, so the output mix is left out
+    template <bool Bypassed, typename Lines>
+    void processLines (float* left, float* right, int numSamples, const Lines& lines) noexcept
+    {
+        // Switching between the RAM buffers and another storage (the plugin's
+        // long mode): the other one holds none of this history, only whatever
+        // it was left with, and the heads have to be seated in its size
+        if (getStorageTag<Lines>() != linesTag || lines.getSize() != linesSize)
+        {
+            linesTag = getStorageTag<Lines>();
+            linesSize = lines.getSize();
+            seatPointers (linesSize);
+            forgetHistories();
+        }
+
+        // The FDN lays the memory out differently, what the other layout left
+        // there would come back as noise
+        if (getFdnLineCount (params.fdnLines) != fdnLines)
+        {
+            fdnLines = getFdnLineCount (params.fdnLines);
+            fdnWritePos = 0;
+            fdnSegment = 0;
+            forgetHistories();
+        }
+
+        // Multiband lays it out as the bands' interleaved lines, same again
+        if (getMultibandCount() != bands)
+        {
+            bands = getMultibandCount();
+            if (bands > 1)
+                bandBatch.setDelayMemory (delayMemory, getBandBufferSize());
+
+            forgetHistories();
+        }
+
+        if (canSkipNetwork())
+        {
+            if constexpr (! Bypassed)
+            {
+                processDryOnly (left, right, numSamples);
+                guardOutput (left, right, numSamples);
+            }
+
+            networkSkipped = true;
+            return;
+        }
+
+        // Nothing was written while skipped, so what the lines hold is stale
+        if (networkSkipped)
+        {
+            forgetHistories();
+            networkSkipped = false;
+        }
+
+        if (freshPending && ! finishFresh (lines, numSamples))
+            processBlock<Bypassed> (left, right, numSamples, FreshDelayLines<Lines> { lines, *this });
+        else
+            processBlock<Bypassed> (left, right, numSamples, lines);
+
+        guardOutput (left, right, numSamples);
+    }
+
+    template <bool Bypassed, typename Lines>
+    void processBlock (float* left, float* right, int numSamples, const Lines& lines) noexcept
+    {
+        ducker.setParameters (params.duckAmount, params.duckAttackMs, params.duckReleaseMs, params.duckThresholdDb);
+
+        // Without a sidechain it only finishes releasing
+        const bool ducking = sidechain[0] != nullptr ? ! ducker.isIdle() : ! ducker.isReleased();
+
+        if (Bypassed || ! ducking)
+        {
+            processBlock<Bypassed> (left, right, numSamples, lines, nullptr);
+            return;
+        }
+
+        // Ducking: the gain curve a chunk at a time, for the mix to apply
+        for (int start = 0; start < numSamples; start += CHUNK_SIZE)
+        {
+            const int n = std::min (CHUNK_SIZE, numSamples - start);
+            ducker.process (sidechain[0] != nullptr ? sidechain[0] + start : nullptr,
+                            sidechain[1] != nullptr ? sidechain[1] + start : nullptr, n, duckGains);
+            processBlock<Bypassed> (left + start, right + start, n, lines, duckGains);
+        }
+    }
+
+    // duck: the gains for the echoes, or nullptr to leave them as they are
+    template <bool Bypassed, typename Lines>
+    void processBlock (float* left, float* right, int numSamples, const Lines& lines, const float* duck) noexcept
+    {
+        if (economyFactor == 1)
+            processAtNetworkRate<Bypassed> (left, right, numSamples, lines, duck);
+        else
+            processEconomy (left, right, numSamples, lines, duck);
+    }
+
+    //==============================================================================
+    // All dry with no feedback, not frozen: none of the network can be heard,
+    // now or later, except the repeats of what comes in from here, and those
+    // are given up. The histories are left alone and read as silence when the
+    // network starts again, as after reset().
+    bool canSkipNetwork() const noexcept
+    {
+        return params.dryWet <= 0 && gDryWet_param_prev == params.dryWet
+            && params.feedbackL == 0 && feedback_L_param_prev == 0
+            && params.feedbackR == 0 && feedback_R_param_prev == 0
+            && ! params.freeze && ! isFrozen && freezeFadeRemaining == 0
+            && (bands <= 1 || (params.bandFeedback[0] == 0 && params.bandFeedback[1] == 0 && params.bandFeedback[2] == 0));
+    }
+
+    void processDryOnly (float* left, float* right, int numSamples) noexcept
+    {
+        gDryWet = (1-0.8)*params.dryWet + 0.8*gDryWet_param_prev;
+        updateMixGains();
+
+        const float gain = gFactDry * powf (10,(params.volumeDb/20));
+
+        for (auto* channel : { left, right })
+            for (int i = 0; i < numSamples; ++i)
+                channel[i] *= gain;
+    }
+
+    // gFactDry / gFactWet from the smoothed gDryWet
+    void updateMixGains() noexcept
+    {
+        drywet = linearMapping (1.0f, 0.0f, 1.0f, -1.0f, gDryWet);
+
+        if(drywet<-1.0)
+        {
+            drywet = -1.0;
+        }else if (drywet>0.99)
+        {
+            drywet = 1.0;
+        }
+
+        gFactDry = (powf (0.5*(1.0-drywet),0.5));
+        gFactWet = (powf (0.5*(1.0+drywet),0.5));
+    }
+
+    //==============================================================================
+    // The lines as seen after reset(): a position reads as silence unless it has
+    // been written since. The write heads are the engine's own, so this follows
+    // them sample by sample.
+    template <typename Lines>
+    struct FreshDelayLines
+    {
+        const Lines& lines;
+        const PingPongEngine& engine;
+
+        int getSize() const noexcept { return lines.getSize(); }
+
+        bool isFresh (int line, int pos) const noexcept
+        {
+            const int size = lines.getSize();
+            const int head = line < 2 ? engine.gWritePointer_inSig[line] : engine.gWritePointer_crossSig[line - 2];
+
+            int written = head - engine.freshStart;
+            if (written < 0)
+                written += size;
+
+            int age = (pos < size ? pos : pos - size) - engine.freshStart;
+            if (age < 0)
+                age += size;
+
+            return age < written;
+        }
+
+        void write (int line, int pos, float value) const noexcept { lines.write (line, pos, value); }
+
+        float read (int line, int pos) const noexcept
+        {
+            return isFresh (line, pos) ? lines.read (line, pos) : 0.0f;
+        }
+
+        void read4 (int line, int start, float* dest) const noexcept
+        {
+            lines.read4 (line, start, dest);
+
+            for (int k = 0; k < 4; ++k)
+                if (! isFresh (line, start + k))
+                    dest[k] = 0;
+        }
+
+        void readBackwards (int line, int pos, int count, float* dest) const noexcept
+        {
+            lines.readBackwards (line, pos, count, dest);
+
+            const int size = lines.getSize();
+            for (int k = 0; k < count; ++k)
+                if (! isFresh (line, pos - k >= 0 ? pos - k : pos - k + size))
+                    dest[k] = 0;
+        }
+    };
+
+    // Decides whether this block still needs FreshDelayLines. Once the heads are
+    // within a block of wrapping, what hasn't been written since reset() is a
+    // short stretch: it is zeroed and the lines are used as they are again.
+    template <typename Lines>
+    bool finishFresh (const Lines& lines, int numSamples) noexcept
+    {
+        const int size = lines.getSize();
+        const int networkSamples = numSamples / economyFactor + 1;
+
+        int written = gWritePointer_inSig[0] - freshStart;
+        if (written < 0)
+            written += size;
+
+        if (written + networkSamples + DELAY_GUARD < size)
+            return false;
+
+        for (int line = 0; line < 4; ++line)
+            for (int pos = gWritePointer_inSig[0]; pos != freshStart; pos = pos + 1 < size ? pos + 1 : 0)
+                lines.write (line, pos, 0.0f);
+
+        freshPending = false;
+        return true;
+    }
+
+    //==============================================================================
+    // Runs the delay network or, when freeze is on, loops what is in the
+    // cross-feedback histories. Going in and out of freeze is crossfaded over
+    // freezeSeamSamples: for that stretch both are rendered and blended.
+    // WetOnly leaves out the dry signal and the mix, for Economy mode and bypass.
+    template <bool WetOnly, typename Lines>
+    void processAtNetworkRate (float* left, float* right, int numSamples, const Lines& lines, const float* duck) noexcept
+    {
+        switch (fdnLines)
+        {
+            case 4:  processFdn<WetOnly, 4>  (left, right, numSamples, lines, duck); return;
+            case 8:  processFdn<WetOnly, 8>  (left, right, numSamples, lines, duck); return;
+            case 16: processFdn<WetOnly, 16> (left, right, numSamples, lines, duck); return;
+            default: break;
+        }
+
+        if (bands > 1)
+        {
+            processMultiband<WetOnly> (left, right, numSamples, duck);
+            return;
+        }
+
+        if (params.freeze != isFrozen)
+        {
+            if (params.freeze)
+                captureFreezeLoop (lines);
+
+            isFrozen = params.freeze;
+            freezeFadeRemaining = freezeSeamSamples;
+        }
+
+        int start = 0;
+
+        while (freezeFadeRemaining > 0 && start < numSamples)
+        {
+            const int n = std::min ({ freezeFadeRemaining, numSamples - start, CHUNK_SIZE });
+            float frozenL[CHUNK_SIZE], frozenR[CHUNK_SIZE];
+
+            // Frozen output first: the live network overwrites the input in place
+            const float* const chunkDuck = duck != nullptr ? duck + start : nullptr;
+            processFrozenLoop<WetOnly> (left + start, right + start, frozenL, frozenR, n, lines, chunkDuck);
+            processDelayNetwork<WetOnly> (left + start, right + start, n, lines, chunkDuck);
+
+            float* const outputs[] = { left + start, right + start };
+            const float* const frozen[] = { frozenL, frozenR };
+
+            for (int channel = 0; channel < 2; ++channel)
+            {
+                for (int i = 0; i < n; ++i)
+                {
+                    // share of the frozen loop, ramping towards the new state
+                    const float progress = (float) (freezeSeamSamples - freezeFadeRemaining + i + 1) / (float) freezeSeamSamples;
+                    const float g = isFrozen ? progress : 1.0f - progress;
+                    outputs[channel][i] = g*frozen[channel][i] + (1-g)*outputs[channel][i];
+                }
+            }
+
+            freezeFadeRemaining -= n;
+            start += n;
+        }
+
+        if (start >= numSamples)
+            return;
+
+        if (duck != nullptr)
+            duck += start;
+
+        if (isFrozen)
+            processFrozenLoop<WetOnly> (left + start, right + start, left + start, right + start, numSamples - start, lines, duck);
+        else
+            processDelayNetwork<WetOnly> (left + start, right + start, numSamples - start, lines, duck);
+    }
+
+    //==============================================================================
+    // The histories, and the network state fed from them, read as silence from here
+    void forgetHistories() noexcept
+    {
+        crossSig_R = crossSig_L = 0;
+        crossSig_R_del_R = crossSig_R_del_L = crossSig_L_del_L = crossSig_L_del_R = 0;
+        inSig_L_del_L = inSig_R_del_R = 0;
+
+        resetRateConverters();
+
+        convolution[0].reset();
+        convolution[1].reset();
+
+        diffuser.reset();
+        diffusionRunning = false;
+        diffusionLevel = 0;
+
+        shimmerRunning = false;
+        shimmerLevel = 0;
+
+        reverseRunning = false;
+        reverseLevel = 0;
+
+        driveRunning = false;
+        driveLevel = 0;
+
+        // The FDN and the bands mask their own reads (fdnWritten, PingPongBatch::forget()),
+        // the ping-pong's go through FreshDelayLines
+        fdnWritten = 0;
+        freshStart = gWritePointer_inSig[0];
+        freshPending = fdnLines <= 2 && bands <= 1;
+
+        if (bands > 1)
+        {
+            bandBatch.forget();
+            crossover.reset();
+        }
+    }
+
+    void resetRateConverters() noexcept
+    {
+        for (int channel = 0; channel < 2; ++channel)
+        {
+            decimator1[channel].reset();
+            decimator2[channel].reset();
+            interpolator1[channel].reset();
+            interpolator2[channel].reset();
+
+            // Primed so the interpolators always have a block's worth ready
+            std::fill (wetFifo[channel], wetFifo[channel] + economyFactor - 1, 0.0f);
+        }
+        wetFifoCount = economyFactor - 1;
+    }
+
+    // Linear below the knee, then bends into the ceiling with a continuous slope
+    static inline float softLimit (float x, float knee, float ceiling) noexcept
+    {
+        const float magnitude = std::fabs (x);
+        if (magnitude <= knee)
+            return x;
+
+        const float range = ceiling - knee;
+        return std::copysign (knee + range * std::tanh ((magnitude - knee) / range), x);
+    }
+
+    void guardOutput (float* left, float* right, int numSamples) noexcept
+    {
+        const auto& kernels = getPingPongKernels();
+        const float peak = std::max (kernels.peak (left, numSamples), kernels.peak (right, numSamples));
+
+        if (peak <= OUTPUT_KNEE)
+            return;
+
+        if (! (peak < RUNAWAY_LEVEL))
+        {
+            // Whatever is in the histories would come back on every repeat, so
+            // reset() makes them read as silence
+            std::fill (left, left + numSamples, 0.0f);
+            std::fill (right, right + numSamples, 0.0f);
+            reset();
+            guardTrips.fetch_add (1, std::memory_order_relaxed);
+            return;
+        }
+
+        if (params.softLimit)
+        {
+            for (auto* channel : { left, right })
+                for (int i = 0; i < numSamples; ++i)
+                    channel[i] = softLimit (channel[i], OUTPUT_KNEE, OUTPUT_CEILING);
+        }
+    }
+
+    //==============================================================================
+    // Economy: decimate, run the network wet-only at the low rate, interpolate
+    // the repeats back up and mix them with the full rate dry signal.
+    template <typename Lines>
+    void processEconomy (float* left, float* right, int numSamples, const Lines& lines, const float* duck) noexcept
+    {
+        // The network smooths dry/wet to its target within a sample, so at full
+        // rate the gains are per block
+        float mix = (float) linearMapping (1.0f, 0.0f, 1.0f, -1.0f, params.dryWet);
+        mix = mix < -1.0f ? -1.0f : (mix > 0.99f ? 1.0f : mix);
+        const float volume = powf (10,(params.volumeDb/20));
+        const float factDry = powf (0.5f*(1.0f-mix),0.5f) * volume;
+        const float factWet = powf (0.5f*(1.0f+mix),0.5f) * volume;
+
+        for (int start = 0; start < numSamples; start += CHUNK_SIZE)
+        {
+            const int n = std::min (CHUNK_SIZE, numSamples - start);
+            float* const io[] = { left + start, right + start };
+
+            // Down to the network rate
+            float lowL[CHUNK_SIZE], lowR[CHUNK_SIZE];
+            int numLow = 0;
+
+            for (int i = 0; i < n; ++i)
+            {
+                if (decimate (io[0][i], io[1][i], lowL[numLow], lowR[numLow]))
+                    ++numLow;
+            }
+
+            processAtNetworkRate<true> (lowL, lowR, numLow, lines, nullptr);
+
+            // Back up into the FIFO, which always holds at least n samples by now
+            for (int j = 0; j < numLow; ++j)
+                interpolate (lowL[j], lowR[j]);
+
+            for (int channel = 0; channel < 2; ++channel)
+            {
+                float* out = io[channel];
+                const float* wet = wetFifo[channel];
+
+                if (duck != nullptr)
+                    for (int i = 0; i < n; ++i)
+                        out[i] = (out[i] + duck[start + i]*wet[i])*factWet + out[i]*factDry;
+                else
+                    for (int i = 0; i < n; ++i)
+                        out[i] = (out[i] + wet[i])*factWet + out[i]*factDry;
+
+                std::memmove (wetFifo[channel], wetFifo[channel] + n, sizeof (float) * (size_t) (wetFifoCount - n));
+            }
+
+            wetFifoCount -= n;
+        }
+    }
+
+    bool decimate (float inL, float inR, float& outL, float& outR) noexcept
+    {
+        float halfL = 0, halfR = 0;
+        decimator1[1].push (inR, halfR);
+
+        if (! decimator1[0].push (inL, halfL))
+            return false;
+
+        if (economyFactor == 2)
+        {
+            outL = halfL;
+            outR = halfR;
+            return true;
+        }
+
+        decimator2[1].push (halfR, outR);
+        return decimator2[0].push (halfL, outL);
+    }
+
+    void interpolate (float wetL, float wetR) noexcept
+    {
+        float* const dest[] = { wetFifo[0] + wetFifoCount, wetFifo[1] + wetFifoCount };
+        const float wet[] = { wetL, wetR };
+
+        for (int channel = 0; channel < 2; ++channel)
+        {
+            if (economyFactor == 2)
+            {
+                interpolator1[channel].push (wet[channel], dest[channel]);
+            }
+            else
+            {
+                float half[2];
+                interpolator2[channel].push (wet[channel], half);
+                interpolator1[channel].push (half[0], dest[channel]);
+                interpolator1[channel].push (half[1], dest[channel] + 2);
+            }
+        }
+
+        wetFifoCount += economyFactor;
+    }
+
+    //==============================================================================
+    static constexpr int CHUNK_SIZE = 256;  // stack scratch for interleaving, freeze fades and Economy
+
+    static int getFreezeSeamSamples (double sampleRate) noexcept
+    {
+        return std::max (16, (int) (FREEZE_SEAM_MS*sampleRate/1000));
+    }
+
+    static double linearMapping (float rangeIn_top, float rangeIn_bottom, float rangeOut_top, float rangeOut_bottom, float value) noexcept
+    {
+        double newValue = rangeOut_bottom + ((rangeOut_top - rangeOut_bottom) * (value - rangeIn_bottom) / (rangeIn_top - rangeIn_bottom));
+        return newValue;
+    }
+
+    void resetPointers() noexcept
+    {
+        for (int channel = 0; channel < 2; ++channel)
+        {
+            gWritePointer_inSig[channel] = gInitLatency;
+            gReadPointer_inSig[channel] = 0;
+            gWritePointer_crossSig[channel] = gInitLatency;
+            gReadPointer_crossSig[channel] = 0;
+        }
+    }
+
+    // The write heads where they are (within size), the read heads their
+    // lead behind
+    void seatPointers (int size) noexcept
+    {
+        for (int channel = 0; channel < 2; ++channel)
+        {
+            gWritePointer_inSig[channel] %= size;
+            gWritePointer_crossSig[channel] %= size;
+            gReadPointer_inSig[channel] = (gWritePointer_inSig[channel] - gInitLatency + size) % size;
+            gReadPointer_crossSig[channel] = (gWritePointer_crossSig[channel] - gInitLatency + size) % size;
+        }
+    }
+
+    // One per line storage type, to tell when a block comes from another one
+    template <typename Lines>
+    static const void* getStorageTag() noexcept
+    {
+        static const char tag = 0;
+        return &tag;
+    }
+
+    template <typename Format>
+    RamDelayLines<Format> makeRamDelayLines() const noexcept
+    {
+        using Stored = typename Format::Stored;
+
+        return { { static_cast<Stored*> (gDelayBuffer_inSig[0]), static_cast<Stored*> (gDelayBuffer_inSig[1]),
+                   static_cast<Stored*> (gDelayBuffer_crossSig[0]), static_cast<Stored*> (gDelayBuffer_crossSig[1]) },
+                 bufferSize };
+    }
+
+    //==============================================================================
+    // Cubic Lagrange read around the tap, or whichever order tapInterpolator
+    // has, crossfaded from the previous one while it changes
+    template <typename Lines>
+    inline float readDelayTap (const Lines& lines, int line, int readPointer, int delaySamples, float alpha) const noexcept
+    {
+        const int size = lines.getSize();
+        int index_m1 = (readPointer - delaySamples - 1 + size) % size;
+
+        if (tapInterpolator.isPlainCubic())
+        {
+            float s[4];
+            lines.read4 (line, index_m1, s);
+
+            return ( alpha*(alpha-1)*(alpha-2)*s[0]/(-6)
+                   + (alpha-1)*(alpha+1)*(alpha-2)*s[1]/2
+                   + alpha*(alpha+1)*(alpha-2)*s[2]/(-2)
+                   + alpha*(alpha+1)*(alpha-1)*s[3]/(6) );
+        }
+
+        const float value = interpolateTap (lines, line, index_m1, alpha, tapInterpolator.quality);
+
+        if (! tapInterpolator.fading)
+            return value;
+
+        const float mix = tapInterpolator.mix;
+        return mix*value + (1 - mix)*interpolateTap (lines, line, index_m1, alpha, tapInterpolator.previous);
+    }
+
+    // index_m1 is the point before the tap, alpha the position between the next two
+    template <typename Lines>
+    static float interpolateTap (const Lines& lines, int line, int index_m1, float alpha, TapQuality quality) noexcept
+    {
+        if (quality == TapQuality::sinc)
+        {
+            const auto& table = SincTable::get();
+            const float phase = alpha * SincTable::PHASES;
+            const int p = std::min ((int) phase, SincTable::PHASES - 1);
+            const float t = phase - (float) p;
+
+            const int size = lines.getSize();
+            int pos = index_m1 + 1 + SincTable::FIRST;
+            pos = pos < 0 ? pos + size : (pos >= size ? pos - size : pos);
+
+            float value = 0;
+            for (int j = 0; j < SincTable::POINTS; ++j)
+            {
+                const float weight = table.weights[p][j] + t*(table.weights[p + 1][j] - table.weights[p][j]);
+                value += weight * lines.read (line, pos);
+
+                if (++pos >= size)
+                    pos = 0;
+            }
+            return value;
+        }
+
+        float s[4];
+        lines.read4 (line, index_m1, s);
+
+        if (quality == TapQuality::linear)
+            return s[1] + alpha*(s[2] - s[1]);
+
+        return ( alpha*(alpha-1)*(alpha-2)*s[0]/(-6)
+               + (alpha-1)*(alpha+1)*(alpha-2)*s[1]/2
+               + alpha*(alpha+1)*(alpha-2)*s[2]/(-2)
+               + alpha*(alpha+1)*(alpha-1)*s[3]/(6) );
+    }
+
+    // The taps of one side: a single read, two crossfaded while a Fade-mode change
+    // runs, or several averaged while a Tape-mode head moves fast
+    template <typename Lines>
+    inline float readDelayTapSet (const Lines& lines, int line, int readPointer, const DelayTapSet& taps) const noexcept
+    {
+        float value = readDelayTap (lines, line, readPointer, taps.a.samples, taps.a.frac);
+
+        if (taps.numSubTaps > 1)
+        {
+            // Tape mode moving fast: average reads over the stretch passed this sample
+            for (int k = 1; k < taps.numSubTaps; ++k)
+            {
+                const auto sub = DelayTap::fromMovingSamples (taps.aSamples - k*taps.subStep);
+                value += readDelayTap (lines, line, readPointer, sub.samples, sub.frac);
+            }
+
+            return value / taps.numSubTaps;
+        }
+
+        if (taps.fading)
+            value = taps.gainA*value + taps.gainB*readDelayTap (lines, line, readPointer, taps.b.samples, taps.b.frac);
+
+        return value;
+    }
+
+    // A repeat of the ping-pong: the taps as they are, or with Shimmer, mixed
+    // with the two pitch-shifting heads around them
+    template <typename Lines>
+    inline float readRepeat (const Lines& lines, int line, int readPointer, const DelayTapSet& taps, bool shimmer) const noexcept
+    {
+        if (! shimmer)
+            return readDelayTapSet (lines, line, readPointer, taps);
+
+        const float maxDelay = (float) (lines.getSize() - INIT_LATENCY - 4);
+        float shifted = 0;
+
+        if (! taps.fading && taps.numSubTaps == 1)
+        {
+            // The usual case: each head is a single read, offset from the tap
+            for (int h = 0; h < 2; ++h)
+            {
+                if (shimmerHeads.gain[h] > 0)
+                {
+                    const auto head = getShiftedTap (taps.a, shimmerHeads.offset[h], maxDelay);
+                    shifted += shimmerHeads.gain[h] * readDelayTap (lines, line, readPointer, head.samples, head.frac);
+                }
+            }
+        }
+        else
+        {
+            for (int h = 0; h < 2; ++h)
+                if (shimmerHeads.gain[h] > 0)
+                    shifted += shimmerHeads.gain[h] * readDelayTapSet (lines, line, readPointer, getShiftedTaps (taps, shimmerHeads.offset[h], maxDelay));
+        }
+
+        if (shimmerLevel >= 1)
+            return shifted;
+
+        return shimmerLevel*shifted + (1 - shimmerLevel)*readDelayTapSet (lines, line, readPointer, taps);
+    }
+
+    // The same taps, offset samples more delayed (within 0 .. maxDelay)
+    static DelayTapSet getShiftedTaps (DelayTapSet taps, float offset, float maxDelay) noexcept
+    {
+        taps.a = getShiftedTap (taps.a, offset, maxDelay);
+
+        if (taps.fading)
+            taps.b = getShiftedTap (taps.b, offset, maxDelay);
+
+        if (taps.numSubTaps > 1)
+            taps.aSamples = std::min (std::max (taps.aSamples + offset, 0.0f), maxDelay);
+
+        return taps;
+    }
+
+    static DelayTap getShiftedTap (DelayTap tap, float offset, float maxDelay) noexcept
+    {
+        // The cubic read moves frac samples towards the write head
+        return DelayTap::fromMovingSamples (std::min (std::max ((float) tap.samples - tap.frac + offset, 0.0f), maxDelay));
+    }
+
+    // The same taps, a latency's worth less delayed (never ahead of the write head)
+    static DelayTapSet getEarlierTaps (DelayTapSet taps, int latency) noexcept
+    {
+        taps.a.samples = std::max (taps.a.samples - latency, 0);
+        taps.b.samples = std::max (taps.b.samples - latency, 0);
+        taps.aSamples = std::max (taps.aSamples - (float) latency, 0.0f);
+        return taps;
+    }
+
+    //==============================================================================
+    template <typename Lines>
+    void captureFreezeLoop (const Lines& lines) noexcept
+    {
+        const int size = lines.getSize();
+
+        // One round trip of the ping-pong, so the loop repeats the L and R echoes in
+        // turn. Bounded so the seam pre-roll and the live writes during the fade-in
+        // never reach into the loop.
+        int loopLength = (int) std::round ((del_L + del_R)*networkRate/1000);
+        loopLength = std::min (std::max (loopLength, 2*freezeSeamSamples), size - 3*freezeSeamSamples - gInitLatency);
+
+        freezeLoopLength = loopLength;
+        freezeLoopStart = ((gWritePointer_crossSig[0] - loopLength) % size + size) % size;
+        freezePhase = 0;
+    }
+
+    // Plays the captured loop straight out of the cross-feedback histories: no
+    // interpolation, no writes, no feedback recursion. The outputs may be the inputs.
+    template <bool WetOnly, typename Lines>
+    void processFrozenLoop (const float* inputL, const float* inputR, float* outputL, float* outputR,
+                            int numSamples, const Lines& lines, const float* duck) noexcept
+    {
+        const int size = lines.getSize();
+        const int seamStart = freezeLoopLength - freezeSeamSamples;
+        const float seamScale = 1.0f / (float) freezeSeamSamples;
+
+        // Gains only change by automation while frozen, once per block is enough
+        float mix = std::min (1.0f, std::max (-1.0f, (float) linearMapping (1.0f, 0.0f, 1.0f, -1.0f, params.dryWet)));
+        const float volume = powf (10,(params.volumeDb/20));
+        const float factDry = powf (0.5f*(1.0f-mix),0.5f) * volume;
+        const float factWet = powf (0.5f*(1.0f+mix),0.5f) * volume;
+        const float outGain[] = { c1, c2 };
+
+        const float* const inputs[] = { inputL, inputR };
+        float* const outputs[] = { outputL, outputR };
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            int pos = freezeLoopStart + freezePhase;
+            if (pos >= size)
+                pos -= size;
+
+            float seamGain = 0;
+            int prePos = 0;
+            if (freezePhase >= seamStart)
+            {
+                // blend into the samples just before the loop start, so the wrap is seamless
+                seamGain = (float) (freezePhase - seamStart + 1) * seamScale;
+                prePos = pos - freezeLoopLength;
+                if (prePos < 0)
+                    prePos += size;
+            }
+
+            for (int channel = 0; channel < 2; ++channel)
+            {
+                float wet = lines.read (2 + channel, pos);
+                if (seamGain > 0)
+                    wet += seamGain*(lines.read (2 + channel, prePos) - wet);
+
+                const float in = inputs[channel][i];
+
+                if constexpr (WetOnly)
+                    outputs[channel][i] = outGain[channel]*wet;
+                else if (duck != nullptr)
+                    outputs[channel][i] = (in + duck[i]*outGain[channel]*wet)*factWet + in*factDry;
+                else
+                    outputs[channel][i] = (in + outGain[channel]*wet)*factWet + in*factDry;
+            }
+
+            if (++freezePhase >= freezeLoopLength)
+                freezePhase = 0;
+        }
+    }
+
+    //==============================================================================
+    // Bands asked for, where they can run: over the ping-pong's RAM buffers
+    int getMultibandCount() const noexcept
+    {
+        if (fdnLines != 2 || delayMemory == nullptr)
+            return 1;
+
+        return params.bands >= 3 ? 3 : (params.bands >= 2 ? 2 : 1);
+    }
+
+    // Frames of the bands' lines that fit in the delay memory
+    int getBandBufferSize() const noexcept
+    {
+        const size_t memory = getRequiredMemory (bufferSize, delayStorageFormat);
+        int frames = (int) (memory / (4 * MULTIBAND_LANES * sizeof (float))) - DELAY_GUARD;
+
+        while (frames > 0 && PingPongBatch<MULTIBAND_LANES>::getRequiredMemory (frames) > memory)
+            --frames;
+
+        return std::max (frames, 0);
+    }
+
+    // Lanes are low, (mid,) high and silent ones; each band ping-pongs wet
+    // only, the mix is done here against the unfiltered input
+    template <bool WetOnly>
+    void processMultiband (float* left, float* right, int numSamples, const float* duck) noexcept
+    {
+        crossover.setup (bands, params.crossoverLowHz, params.crossoverHighHz, networkRate);
+
+        const float maxDelayMs = getMaxBandDelayMs();
+
+        for (int lane = 0; lane < MULTIBAND_LANES; ++lane)
+        {
+            PingPongParameters p;
+
+            if (lane < bands)
+            {
+                const int band = bands == 3 ? lane : 2*lane;    // 2 bands: low and high
+                p.delayL = p.delayR = std::min (std::max (params.bandDelayMs[band], 0.0f), maxDelayMs);
+                p.feedbackL = p.feedbackR = params.bandFeedback[band];
+            }
+
+            bandBatch.setParameters (lane, p);
+        }
+
+        // Per block, like the FDN
+        float mix = std::min (1.0f, std::max (-1.0f, (float) linearMapping (1.0f, 0.0f, 1.0f, -1.0f, params.dryWet)));
+        const float volume = powf (10,(params.volumeDb/20));
+        const float factDry = powf (0.5f*(1.0f-mix),0.5f) * volume;
+        const float factWet = powf (0.5f*(1.0f+mix),0.5f) * volume;
+        gDryWet_param_prev = params.dryWet;
+
+        alignas (64) float bandL[MULTIBAND_LANES][CHUNK_SIZE], bandR[MULTIBAND_LANES][CHUNK_SIZE];
+        float inputL[CHUNK_SIZE], inputR[CHUNK_SIZE];
+        float* const lanesL[] = { bandL[0], bandL[1], bandL[2], bandL[3] };
+        float* const lanesR[] = { bandR[0], bandR[1], bandR[2], bandR[3] };
+
+        for (int lane = bands; lane < MULTIBAND_LANES; ++lane)
+        {
+            std::fill (bandL[lane], bandL[lane] + CHUNK_SIZE, 0.0f);
+            std::fill (bandR[lane], bandR[lane] + CHUNK_SIZE, 0.0f);
+        }
+
+        for (int start = 0; start < numSamples; start += CHUNK_SIZE)
+        {
+            const int n = std::min (CHUNK_SIZE, numSamples - start);
+
+            // Split, keeping the sum of the bands (the input, allpassed) to take off again
+            for (int i = 0; i < n; ++i)
+            {
+                float splitL[CrossoverFilterbank::MAX_BANDS], splitR[CrossoverFilterbank::MAX_BANDS];
+                crossover.process (left[start + i], right[start + i], splitL, splitR);
+
+                inputL[i] = inputR[i] = 0;
+                for (int b = 0; b < bands; ++b)
+                {
+                    bandL[b][i] = splitL[b];
+                    bandR[b][i] = splitR[b];
+                    inputL[i] += splitL[b];
+                    inputR[i] += splitR[b];
+                }
+            }
+
+            bandBatch.process (lanesL, lanesR, n);
+
+            for (int i = 0; i < n; ++i)
+            {
+                float wetL = -inputL[i], wetR = -inputR[i];
+                for (int b = 0; b < bands; ++b)
+                {
+                    wetL += bandL[b][i];
+                    wetR += bandR[b][i];
+                }
+
+                float* const outputs[] = { left + start, right + start };
+                const float duckGain = duck != nullptr ? duck[start + i] : 1.0f;
+                const float wet[] = { duckGain*c1*wetL, duckGain*c2*wetR };
+
+                for (int channel = 0; channel < 2; ++channel)
+                {
+                    const float in = outputs[channel][i];
+
+                    if constexpr (WetOnly)
+                        outputs[channel][i] = wet[channel];
+                    else
+                        outputs[channel][i] = (in + wet[channel])*factWet + in*factDry;
+                }
+            }
+        }
+    }
+
+    //==============================================================================
+    static int getFdnLineCount (int requested) noexcept
+    {
+        return requested >= 16 ? 16 : (requested >= 8 ? 8 : (requested >= 4 ? 4 : 2));
+    }
+
+    // Line k is stored in line k % 4 of the memory, in segment k / 4 of it
+    template <bool WetOnly, int N, typename Lines>
+    void processFdn (float* left, float* right, int numSamples, const Lines& lines, const float* duck) noexcept
+    {
+        const int segment = lines.getSize() / (N / 4);
+
+        if (segment != fdnSegment)
+            fdnWritten = 0;
+
+        if (segment != fdnSegment || params.delayL != fdnDelayMs[0] || params.delayR != fdnDelayMs[1])
+            updateFdnDelays (N, segment);
+
+        if (fdnWritePos >= segment)
+            fdnWritePos = 0;
+
+        const bool frozen = params.freeze;
+        const float gainL = frozen ? 1.0f : params.feedbackL;
+        const float gainR = frozen ? 1.0f : params.feedbackR;
+
+        // Each side spreads over N/2 lines and is gathered back from them
+        const float sideScale = 1.0f / std::sqrt ((float) (N / 2));
+        const float inputGain = frozen ? 0.0f : sideScale;
+        const bool limitFeedback = params.softLimit;
+
+        auto matrix = params.fdnMatrix;
+        if (matrix == FeedbackMatrixType::user && userFeedbackMatrix.size != N)
+            matrix = FeedbackMatrixType::hadamard;
+
+        // Per block, like the frozen loop
+        float mix = std::min (1.0f, std::max (-1.0f, (float) linearMapping (1.0f, 0.0f, 1.0f, -1.0f, params.dryWet)));
+        const float volume = powf (10,(params.volumeDb/20));
+        const float factDry = powf (0.5f*(1.0f-mix),0.5f) * volume;
+        const float factWet = powf (0.5f*(1.0f+mix),0.5f) * volume;
+        gDryWet_param_prev = params.dryWet;
+
+        float x[N];
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            for (int k = 0; k < N; ++k)
+            {
+                int pos = fdnWritePos - fdnDelays[k];
+                if (pos < 0)
+                    pos += segment;
+
+                x[k] = fdnDelays[k] <= fdnWritten ? lines.read (k & 3, (k >> 2) * segment + pos) : 0.0f;
+            }
+
+            float wetL = 0, wetR = 0;
+            for (int k = 0; k < N; k += 2)
+            {
+                wetL += x[k];
+                wetR += x[k + 1];
+                x[k] *= gainL;
+                x[k + 1] *= gainR;
+            }
+
+            if (matrix == FeedbackMatrixType::householder)
+                applyHouseholder<N> (x);
+            else if (matrix == FeedbackMatrixType::user)
+                userFeedbackMatrix.apply<N> (x);
+            else
+                applyHadamard<N> (x);
+
+            const float inL = left[i] * inputGain;
+            const float inR = right[i] * inputGain;
+
+            for (int k = 0; k < N; k += 2)
+            {
+                x[k] += inL;
+                x[k + 1] += inR;
+            }
+
+            if (limitFeedback)
+                for (int k = 0; k < N; ++k)
+                    x[k] = softLimit (x[k], FEEDBACK_KNEE, FEEDBACK_CEILING);
+
+            for (int k = 0; k < N; ++k)
+                lines.write (k & 3, (k >> 2) * segment + fdnWritePos, x[k]);
+
+            if (++fdnWritePos >= segment)
+                fdnWritePos = 0;
+            if (fdnWritten < segment)
+                ++fdnWritten;
+
+            wetL *= sideScale;
+            wetR *= sideScale;
+
+            // Like the ping-pong, the wet side carries the input too
+            if constexpr (WetOnly)
+            {
+                left[i] = wetL;
+                right[i] = wetR;
+            }
+            else
+            {
+                if (duck != nullptr)
+                {
+                    wetL *= duck[i];
+                    wetR *= duck[i];
+                }
+
+                left[i] = (left[i] + wetL)*factWet + left[i]*factDry;
+                right[i] = (right[i] + wetR)*factWet + right[i]*factDry;
+            }
+        }
+    }
+
+    // Each side's lines spread geometrically over up to a fifth (x1.5) above
+    // its delay time, odd lengths and no two the same, so their repeats
+    // don't pile up
+    void updateFdnDelays (int numLines, int segment) noexcept
+    {
+        fdnSegment = segment;
+        fdnDelayMs[0] = params.delayL;
+        fdnDelayMs[1] = params.delayR;
+
+        for (int k = 0; k < numLines; ++k)
+        {
+            const float spread = std::pow (1.5f, (float) (k >> 1) / (float) (numLines / 2));
+            int d = (int) (fdnDelayMs[k & 1] * spread * networkRate / 1000) | 1;
+
+            for (int m = 0; m < k; ++m)
+            {
+                if (fdnDelays[m] == d)
+                {
+                    d += 2;
+                    m = -1;     // check against all of them again
+                }
+            }
+
+            fdnDelays[k] = std::min (std::max (d, 1), segment - 1);
+        }
+    }
+
+    //==============================================================================
+    template <bool WetOnly, typename Lines>
+    void processDelayNetwork (float* const outputL, float* const outputR, int numSamples, const Lines& lines, const float* duck) noexcept
+    {
+        const int size = lines.getSize();
+
+        float* const buffers[] = { outputL, outputR };
+
+        const float targetDel_L = params.delayL;
+        const float targetDel_R = params.delayR;
+        const auto timeMode = params.timeMode;
+        const float samplesPerMs = networkRate/1000;
+        const bool limitFeedback = params.softLimit;
+
+        tapInterpolator.setQuality (params.tapQuality, (int) (QUALITY_FADE_MS*samplesPerMs));
+
+        const int fadeLength = (int) (params.fadeMs*samplesPerMs);
+        delayTimeFade_L.setFadeLength (fadeLength);
+        delayTimeFade_R.setFadeLength (fadeLength);
+
+        // Tape: rate is in seconds of delay per second, so it needs no rate scaling
+        tapeSlew_L.setRate (params.tapeRate, TAPE_SETTLE_MS*samplesPerMs);
+        tapeSlew_R.setRate (params.tapeRate, TAPE_SETTLE_MS*samplesPerMs);
+
+        DelayTapSet taps_L, taps_R;
+
+        // Volume is per block, and so is dry/wet once its smoothing has settled
+        // (within a sample of a change). At either end the mix then leaves out
+        // the side that can't be heard.
+        const float volume = powf (10,(params.volumeDb/20));
+        const bool mixSettled = gDryWet_param_prev == params.dryWet;
+
+        if (mixSettled && ! WetOnly)
+        {
+            gDryWet = (1-0.8)*params.dryWet + 0.8*gDryWet_param_prev;
+            updateMixGains();
+        }
+
+        const bool allWet = mixSettled && gFactDry == 0;
+        const bool allDry = mixSettled && gFactWet == 0;
+
+        // IR colouring and diffusion: each side's repeats (L's come out of the
+        // R history and the other way round) go through its convolver, then
+        // both through the diffuser, fed from taps read early by their
+        // latencies. Each needs that much delay to work with.
+        const float reach_L = std::min (targetDel_L, del_L)*samplesPerMs;
+        const float reach_R = std::min (targetDel_R, del_R)*samplesPerMs;
+        const int convolutionLead = PartitionedConvolver::PARTITION_SIZE;
+        const int diffusionLead = (params.diffusion > 0 || diffusionRunning) ? diffuser.getLatency() : 0;
+
+        convolution[0].update (networkRate, reach_L - (float) diffusionLead);
+        convolution[1].update (networkRate, reach_R - (float) diffusionLead);
+
+        const bool colour_L = convolution[0].isRunning();
+        const bool colour_R = convolution[1].isRunning();
+
+        updateDiffusion (std::min (reach_L - (colour_L ? convolutionLead : 0),
+                                   reach_R - (colour_R ? convolutionLead : 0)) >= (float) diffuser.getLatency(),
+                         numSamples);
+
+        const bool diffuse = diffusionRunning;
+        float diffused[2] = { 0, 0 };
+
+        // Shimmer: its heads reach half a window either side of every tap above
+        const float lead_L = (float) ((diffuse ? diffusionLead : 0) + (colour_L ? convolutionLead : 0));
+        const float lead_R = (float) ((diffuse ? diffusionLead : 0) + (colour_R ? convolutionLead : 0));
+
+        updateShimmer (std::min (reach_L - lead_L, reach_R - lead_R) >= shimmerHeads.getReach());
+
+        const bool shimmer = shimmerRunning;
+
+        // Reverse: both sides' segments rendered a chunk ahead
+        updateReverse();
+
+        const bool reverse = reverseRunning;
+        const int maxReverseSegment = reversePlayback[0].getMaxSegment (size - INIT_LATENCY - 4);
+        float reversed[2][ReversePlayback::CHUNK];
+
+        // Drive: the taps are read early by the saturators' latency, so the
+        // echoes stay on time (as far as the delay leaves room to)
+        updateDrive();
+
+        const bool saturate = driveRunning;
+        const float maxTapDelay = (float) (size - INIT_LATENCY - 4);
+        DelayTapSet driveTaps_L, driveTaps_R;
+
+        // Those early taps only change while a delay time or the drive level
+        // moves; otherwise they are worked out on the first sample and kept
+        // for the block
+        const bool driveAtRest = driveStep > 0 ? driveLevel >= 1 : driveLevel <= 0;
+        const bool holdDriveTaps = saturate && driveAtRest && areTapsAtRest (timeMode, targetDel_L, targetDel_R, samplesPerMs);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            tapInterpolator.advance();
+
+            // READ PARAMS
+            if (timeMode == DelayTimeMode::fade)
+            {
+                // Taps stay put and crossfade to a new time when it changes
+                taps_L = delayTimeFade_L.next (targetDel_L, samplesPerMs);
+                taps_R = delayTimeFade_R.next (targetDel_R, samplesPerMs);
+
+                del_L = del_L_param_prev = delayTimeFade_L.getCurrentMs();
+                del_R = del_R_param_prev = delayTimeFade_R.getCurrentMs();
+            }
+            else if (timeMode == DelayTimeMode::tape)
+            {
+                // Read heads slew to the new time at a bounded rate
+                taps_L = tapeSlew_L.next (targetDel_L*samplesPerMs);
+                taps_R = tapeSlew_R.next (targetDel_R*samplesPerMs);
+
+                del_L = del_L_param_prev = (float) (tapeSlew_L.getCurrentSamples()/samplesPerMs);
+                del_R = del_R_param_prev = (float) (tapeSlew_R.getCurrentSamples()/samplesPerMs);
+            }
+            else
+            {
+                del_L = (1-0.99)*targetDel_L + 0.99*del_L_param_prev;
+                del_L_param_prev = del_L;
+
+                del_R = (1-0.99)*targetDel_R + 0.99*del_R_param_prev;
+                del_R_param_prev = del_R;
+
+                // delays in samples
+                taps_L.a = DelayTap::fromSamples (del_L*samplesPerMs);
+                taps_R.a = DelayTap::fromSamples (del_R*samplesPerMs);
+            }
+
+            // The modes not in use follow along, so switching mode doesn't jump
+            if (timeMode != DelayTimeMode::fade)
+            {
+                delayTimeFade_L.reset (del_L);
+                delayTimeFade_R.reset (del_R);
+            }
+            if (timeMode != DelayTimeMode::tape)
+            {
+                tapeSlew_L.reset (del_L*samplesPerMs);
+                tapeSlew_R.reset (del_R*samplesPerMs);
+            }
+
+            if (saturate && (i == 0 || ! holdDriveTaps))
+            {
+                driveLevel = std::min (std::max (driveLevel + driveStep, 0.0f), 1.0f);
+
+                const float lead = driveLevel*saturator[0].getLatency();
+                driveTaps_L = getShiftedTaps (taps_L, -lead, maxTapDelay);
+                driveTaps_R = getShiftedTaps (taps_R, -lead, maxTapDelay);
+            }
+
+            // What goes into the saturators, the input tap as much as the
+            // repeats, is read that much early
+            const DelayTapSet& loopTaps_L = saturate ? driveTaps_L : taps_L;
+            const DelayTapSet& loopTaps_R = saturate ? driveTaps_R : taps_R;
+
+            if (reverse && (i & (ReversePlayback::CHUNK - 1)) == 0)
+            {
+                const int n = std::min (ReversePlayback::CHUNK, numSamples - i);
+                const int length[] = { std::min ((int) (del_L*samplesPerMs), maxReverseSegment),
+                                       std::min ((int) (del_R*samplesPerMs), maxReverseSegment) };
+
+                for (int channel = 0; channel < 2; ++channel)
+                    reversePlayback[channel].render (lines, channel, gReadPointer_inSig[channel] - ReversePlayback::LAG,
+                                                     length[channel], n, reversed[channel]);
+            }
+
+            for (int channel = 0; channel < 2; ++channel) // doing this because im overwriting the first channel after going through the first iteration of the loop !
+            {
+                auto* input = buffers[channel];
+
+                // Current input sample
+                float in = input[i];
+
+                outValDry[channel] = in; // Dry output
+
+                feedback_L = (1-0.8)*params.feedbackL + 0.8*feedback_L_param_prev;
+                feedback_L_param_prev = params.feedbackL;
+
+                feedback_R = (1-0.8)*params.feedbackR + 0.8*feedback_R_param_prev;
+                feedback_R_param_prev = params.feedbackR;
+
+                gDryWet = (1-0.8)*params.dryWet + 0.8*gDryWet_param_prev;
+                gDryWet_param_prev = params.dryWet;
+
+                if (channel == 0)
+                {
+                    if (shimmer)
+                    {
+                        shimmerHeads.advance();
+                        shimmerLevel = shimmerLevel < shimmerTarget ? std::min (shimmerLevel + shimmerStep, shimmerTarget)
+                                                                    : std::max (shimmerLevel - shimmerStep, shimmerTarget);
+                    }
+
+                    lines.write (channel, gWritePointer_inSig[channel], in);
+
+                    if (reverse)
+                    {
+                        reverseLevel = std::min (std::max (reverseLevel + reverseStep, 0.0f), 1.0f);
+                        inSig_L_del_L = readReverse (lines, channel, reversed[channel][i & (ReversePlayback::CHUNK - 1)], loopTaps_L);
+                    }
+                    else
+                    {
+                        inSig_L_del_L = readDelayTapSet (lines, channel, gReadPointer_inSig[channel], loopTaps_L);
+                    }
+
+                    crossSig_L = a1*inSig_L_del_L + feedback_L*crossSig_R_del_L;
+                    if (saturate)
+                        crossSig_L += driveLevel*(saturator[0].process (crossSig_L) - crossSig_L);
+                    if (limitFeedback)
+                        crossSig_L = softLimit (crossSig_L, FEEDBACK_KNEE, FEEDBACK_CEILING);
+
+                    lines.write (2 + channel, gWritePointer_crossSig[channel], crossSig_L);
+
+                    crossSig_L_del_L = readDelayTapSet (lines, 2 + channel, gReadPointer_crossSig[channel], loopTaps_L);
+                    crossSig_L_del_R = readRepeat (lines, 2 + channel, gReadPointer_crossSig[channel], loopTaps_R, shimmer);
+
+                    if (diffuse)
+                    {
+                        // Both sides at once: the L side's tap is where channel 1 would read it
+                        float early[2] = { readRepeat (lines, 3, gReadPointer_crossSig[1], getEarlierTaps (loopTaps_L, diffusionLead), shimmer),
+                                           readRepeat (lines, 2, gReadPointer_crossSig[0], getEarlierTaps (loopTaps_R, diffusionLead), shimmer) };
+
+                        if (colour_L)
+                            early[0] = convolution[0].process (readRepeat (lines, 3, gReadPointer_crossSig[1], getEarlierTaps (loopTaps_L, diffusionLead + convolutionLead), shimmer),
+                                                               early[0]);
+                        if (colour_R)
+                            early[1] = convolution[1].process (readRepeat (lines, 2, gReadPointer_crossSig[0], getEarlierTaps (loopTaps_R, diffusionLead + convolutionLead), shimmer),
+                                                               early[1]);
+
+                        diffuser.process (early, diffused);
+                        diffusionLevel = std::min (std::max (diffusionLevel + diffusionStep, 0.0f), 1.0f);
+
+                        crossSig_L_del_R = diffusionLevel*diffused[1] + (1 - diffusionLevel)*crossSig_L_del_R;
+                    }
+                    else if (colour_R)
+                    {
+                        crossSig_L_del_R = convolution[1].process (readRepeat (lines, 2 + channel, gReadPointer_crossSig[channel], getEarlierTaps (loopTaps_R, convolutionLead), shimmer),
+                                                                   crossSig_L_del_R);
+                    }
+
+                    outVal[channel] = in + c1*crossSig_L;
+                }
+                else if (channel == 1)
+                {
+                    lines.write (channel, gWritePointer_inSig[channel], in);
+
+                    if (reverse)
+                        inSig_R_del_R = readReverse (lines, channel, reversed[channel][i & (ReversePlayback::CHUNK - 1)], loopTaps_R);
+                    else
+                        inSig_R_del_R = readDelayTapSet (lines, channel, gReadPointer_inSig[channel], loopTaps_R);
+
+                    crossSig_R = a2*inSig_R_del_R + feedback_R*crossSig_L_del_R;
+                    if (saturate)
+                        crossSig_R += driveLevel*(saturator[1].process (crossSig_R) - crossSig_R);
+                    if (limitFeedback)
+                        crossSig_R = softLimit (crossSig_R, FEEDBACK_KNEE, FEEDBACK_CEILING);
+
+                    lines.write (2 + channel, gWritePointer_crossSig[channel], crossSig_R);
+
+                    crossSig_R_del_R = readDelayTapSet (lines, 2 + channel, gReadPointer_crossSig[channel], loopTaps_R);
+                    crossSig_R_del_L = readRepeat (lines, 2 + channel, gReadPointer_crossSig[channel], loopTaps_L, shimmer);
+
+                    if (diffuse)
+                    {
+                        crossSig_R_del_L = diffusionLevel*diffused[0] + (1 - diffusionLevel)*crossSig_R_del_L;
+                    }
+                    else if (colour_L)
+                    {
+                        crossSig_R_del_L = convolution[0].process (readRepeat (lines, 2 + channel, gReadPointer_crossSig[channel], getEarlierTaps (loopTaps_L, convolutionLead), shimmer),
+                                                                   crossSig_R_del_L);
+                    }
+
+                    outVal[channel] = in + c2*crossSig_R;
+                }
+
+                if constexpr (WetOnly)
+                    buffers[channel][i] = channel == 0 ? c1*crossSig_L : c2*crossSig_R;
+
+                // update gWritePointer
+                gWritePointer_inSig[channel] = gWritePointer_inSig[channel] + 1;
+                if (gWritePointer_inSig[channel] >= size)
+                    gWritePointer_inSig[channel] = 0;
+
+                // update gReadPointer
+                gReadPointer_inSig[channel] = gReadPointer_inSig[channel] + 1;
+                if (gReadPointer_inSig[channel] >= size)
+                    gReadPointer_inSig[channel] = 0;
+
+                // update gWritePointer_head_shadow
+                gWritePointer_crossSig[channel] = gWritePointer_crossSig[channel] + 1;
+                if (gWritePointer_crossSig[channel] >= size)
+                    gWritePointer_crossSig[channel] = 0;
+
+                // update gReadPointer_head_shadow
+                gReadPointer_crossSig[channel] = gReadPointer_crossSig[channel] + 1;
+                if (gReadPointer_crossSig[channel] >= size)
+                    gReadPointer_crossSig[channel] = 0;
+
+                if constexpr (WetOnly)
+                    continue;
+
+                // Ducking turns down the echoes, not the input the wet side carries
+                if (duck != nullptr)
+                    outVal[channel] = outValDry[channel] + duck[i]*(channel == 0 ? c1*crossSig_L : c2*crossSig_R);
+
+                if (! mixSettled)
+                    updateMixGains();
+
+                if (allWet)
+                    buffers[channel][i] = outVal[channel] * gFactWet * volume;
+                else if (allDry)
+                    buffers[channel][i] = outValDry[channel] * gFactDry * volume;
+                else
+                    buffers[channel][i] = (outVal[channel] * gFactWet + outValDry[channel] * gFactDry) * volume;
+            }
+        }
+
+        // Faded out: out of the loop from the next block
+        if (diffusionRunning && diffusionStep < 0 && diffusionLevel <= 0)
+            diffusionRunning = false;
+
+        if (shimmerRunning && shimmerTarget <= 0 && shimmerLevel <= 0)
+            shimmerRunning = false;
+
+        if (reverseRunning && reverseStep < 0 && reverseLevel <= 0)
+            reverseRunning = false;
+
+        if (driveRunning && driveStep < 0 && driveLevel <= 0)
+            driveRunning = false;
+    }
+
+    // Whether the taps will come out the same for every sample of the block:
+    // no delay time is moving in the current mode
+    bool areTapsAtRest (DelayTimeMode timeMode, float targetDel_L, float targetDel_R, float samplesPerMs) const noexcept
+    {
+        if (timeMode == DelayTimeMode::fade)
+            return ! delayTimeFade_L.isFading() && delayTimeFade_L.getCurrentMs() == targetDel_L
+                && ! delayTimeFade_R.isFading() && delayTimeFade_R.getCurrentMs() == targetDel_R;
+
+        if (timeMode == DelayTimeMode::tape)
+            return ! tapeSlew_L.isMoving() && tapeSlew_L.getCurrentSamples() == targetDel_L*samplesPerMs
+                && ! tapeSlew_R.isMoving() && tapeSlew_R.getCurrentSamples() == targetDel_R*samplesPerMs;
+
+        // Jump: the smoothing has reached its fixed point
+        return (float) ((1-0.99)*targetDel_L + 0.99*del_L_param_prev) == del_L_param_prev
+            && (float) ((1-0.99)*targetDel_R + 0.99*del_R_param_prev) == del_R_param_prev;
+    }
+
+    // The input tap while Reverse runs: the reversed sample, mixed with the
+    // forward tap while switching
+    template <typename Lines>
+    inline float readReverse (const Lines& lines, int channel, float reversedSample, const DelayTapSet& taps) const noexcept
+    {
+        if (reverseLevel >= 1)
+            return reversedSample;
+
+        return reverseLevel*reversedSample + (1 - reverseLevel)*readDelayTapSet (lines, channel, gReadPointer_inSig[channel], taps);
+    }
+
+    // Diffusion is in the loop while it is above 0 and the delays are long
+    // enough to take its latency off. Coming in, it fades up over twice the
+    // time its buffers take to fill; going out, over DIFFUSION_FADE_SAMPLES.
+    void updateDiffusion (bool fits, int numSamples) noexcept
+    {
+        const bool wanted = params.diffusion > 0 && fits;
+
+        if (wanted && ! diffusionRunning)
+        {
+            diffuser.reset();
+            diffusionRunning = true;
+            diffusionLevel = 0;
+        }
+
+        if (diffusionRunning)
+        {
+            diffusionStep = wanted ? 1.0f / (float) (2*diffuser.getLatency()) : -1.0f / DIFFUSION_FADE_SAMPLES;
+            diffuser.setAmount (params.diffusion, numSamples);
+        }
+    }
+
+    // Shimmer is in the loop while it is above 0 and the delays are longer than
+    // its heads reach. Its level follows the knob over SHIMMER_FADE_SAMPLES
+    // per unit, in and out.
+    void updateShimmer (bool fits) noexcept
+    {
+        shimmerTarget = fits ? params.shimmer : 0;
+        shimmerStep = 1.0f / SHIMMER_FADE_SAMPLES;
+        shimmerHeads.setInterval (params.shimmerInterval);
+
+        if (shimmerTarget > 0 && ! shimmerRunning)
+        {
+            shimmerHeads.reset();
+            shimmerRunning = true;
+            shimmerLevel = 0;
+        }
+    }
+
+    // Reverse fades in from the start of a segment, and out to the forward
+    // taps, over REVERSE_FADE_SAMPLES
+    void updateReverse() noexcept
+    {
+        if (params.reverse && ! reverseRunning)
+        {
+            reversePlayback[0].reset();
+            reversePlayback[1].reset();
+            reverseRunning = true;
+            reverseLevel = 0;
+        }
+
+        reverseStep = (params.reverse ? 1.0f : -1.0f) / REVERSE_FADE_SAMPLES;
+    }
+
+    // Drive fades in and out over DRIVE_FADE_SAMPLES, the repeats' taps gliding
+    // by the saturators' latency as it does. It runs oversampled with the sinc
+    // taps; a change of tap quality fades it out and back in the other way.
+    void updateDrive() noexcept
+    {
+        const bool oversample = params.tapQuality == TapQuality::sinc;
+
+        if (params.drive > 0 && ! driveRunning)
+        {
+            saturator[0].reset (oversample);
+            saturator[1].reset (oversample);
+            driveRunning = true;
+            driveLevel = 0;
+        }
+
+        if (! driveRunning)
+            return;
+
+        saturator[0].setDrive (params.drive);
+        saturator[1].setDrive (params.drive);
+
+        const bool staying = params.drive > 0 && saturator[0].isOversampled() == oversample;
+        driveStep = (staying ? 1.0f : -1.0f) / DRIVE_FADE_SAMPLES;
+    }
+
+    //==============================================================================
+    PingPongParameters params;
+
+    void* delayMemory = nullptr;
+    int bufferSize = 0;
+    DelaySampleFormat delayStorageFormat = DelaySampleFormat::float32;
+
+    // Typed by delayStorageFormat, see makeRamDelayLines()
+    void* gDelayBuffer_inSig[2] = { nullptr, nullptr }; // delay buffer from input
+    int gWritePointer_inSig[2] = { INIT_LATENCY, INIT_LATENCY }; // write pointer for delay buffer from input
+    int gReadPointer_inSig[2] = { 0, 0 }; // read pointer for delay buffer from input
+
+    void* gDelayBuffer_crossSig[2] = { nullptr, nullptr }; // delay buffer loaded from head shadow model
+    int gWritePointer_crossSig[2] = { INIT_LATENCY, INIT_LATENCY }; // write pointer for delay buffer loaded from head shadow model
+    int gReadPointer_crossSig[2] = { 0, 0 }; // read pointer for delay buffer loaded from head shadow model
+
+    int gInitLatency = INIT_LATENCY;
+
+    float crossSig_R = 0;
+    float crossSig_L = 0;
+    float crossSig_R_del_R = 0;
+    float crossSig_R_del_L = 0;
+    float crossSig_L_del_L = 0;
+    float crossSig_L_del_R = 0;
+    float inSig_L_del_L = 0;
+    float inSig_R_del_R = 0;
+
+    float a1 = 1;
+    float a2 = 1;
+    float c1 = 1;
+    float c2 = 1;
+
+    float gSampleRate = 44100, T = 1 / 44100.0f;
+
+    // Economy: the network runs at networkRate = gSampleRate / economyFactor
+    int economyFactor = 1;
+    float networkRate = 44100;
+    HalfBandDecimator decimator1[2], decimator2[2];         // host -> 1/2, 1/2 -> 1/4
+    HalfBandInterpolator interpolator1[2], interpolator2[2]; // 1/2 -> host, 1/4 -> 1/2
+    float wetFifo[2][CHUNK_SIZE + 4] = {};                  // repeats back at host rate
+    int wetFifoCount = 0;
+
+    std::atomic<unsigned int> guardTrips { 0 };
+
+    TapInterpolator tapInterpolator;
+
+    // reset(): where the write heads were, and whether reads still need masking
+    int freshStart = 0;
+    bool freshPending = false;
+
+    // The last block skipped the network (see canSkipNetwork())
+    bool networkSkipped = false;
+
+    // The line storage the last block used, and its size (see processLines())
+    const void* linesTag = nullptr;
+    int linesSize = 0;
+
+    // FDN mode: one write position for all lines, how much of them has been
+    // written since they were laid out, and the line lengths in samples
+    int fdnLines = 2;
+    int fdnWritePos = 0;
+    int fdnWritten = 0;
+    int fdnSegment = 0;
+    float fdnDelayMs[2] = { -1, -1 };
+    int fdnDelays[UserFeedbackMatrix::MAX_SIZE] = {};
+    UserFeedbackMatrix userFeedbackMatrix;
+
+    // Multiband: the crossover, and the bands' ping-pongs side by side
+    int bands = 1;
+    CrossoverFilterbank crossover;
+    PingPongBatch<MULTIBAND_LANES> bandBatch;
+
+    // IR colouring of the L and R repeats
+    ConvolutionSlot convolution[2];
+
+    // Diffusion: the cascade, and how far it is mixed in over the plain repeats
+    AllpassDiffuser diffuser;
+    bool diffusionRunning = false;
+    float diffusionLevel = 0, diffusionStep = 0;
+
+    // Shimmer: the pitch-shifting heads, and how much of the repeats they make
+    ShimmerHeads shimmerHeads;
+    bool shimmerRunning = false;
+    float shimmerLevel = 0, shimmerTarget = 0, shimmerStep = 0;
+
+    // Reverse: each side's segments, and how far they replace the forward taps
+    ReversePlayback reversePlayback[2];
+    bool reverseRunning = false;
+    float reverseLevel = 0, reverseStep = 0;
+
+    // Ducking, at the host rate; the sidechain is for one block
+    SidechainDucker ducker;
+    const float* sidechain[2] = { nullptr, nullptr };
+    float duckGains[CHUNK_SIZE];
+
+    // Drive: each side's saturator, and how far it is mixed in over the plain loop
+    FeedbackSaturator saturator[2];
+    bool driveRunning = false;
+    float driveLevel = 0, driveStep = 0;
+
+    // Smoothing state
+    float del_L_param_prev = 0;
+    float del_R_param_prev = 0;
+    float feedback_L_param_prev = 0;
+    float feedback_R_param_prev = 0;
+    float gDryWet_param_prev = 0;
+
+    float del_L = 0;
+    float del_R = 0;
+    float feedback_L = 0;
+    float feedback_R = 0;
+    float gDryWet = 0;
+
+    float outVal[2] = { 0, 0 }, outValDry[2] = { 0, 0 };
+
+    float gFactDry = 0, gFactWet = 0;
+    float drywet = 0;
+
+    // What the taps do on a delay time change (see DelayTimeModes.h)
+    DelayTimeFade delayTimeFade_L, delayTimeFade_R;
+    DelayTimeSlew tapeSlew_L, tapeSlew_R;
+
+    // Freeze: loops one ping-pong round trip of the cross-feedback histories
+    bool isFrozen = false;
+    int freezeLoopStart = 0;
+    int freezeLoopLength = 1;
+    int freezePhase = 0;
+    int freezeSeamSamples = 16;
+    int freezeFadeRemaining = 0;
+};
@@ -0,0 +1,423 @@
+/*
+  ==============================================================================
+
+    PingPongKernels.cpp
+
+  ==============================================================================
+*/
+
+#include "PingPongKernels.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+#if defined (__x86_64__) || defined (_M_X64) || defined (__i386__) || defined (_M_IX86)
+ #define PINGPONG_X86 1
+ #include <immintrin.h>
+ #if defined (_MSC_VER) && ! defined (__clang__)
+  #include <intrin.h>
+ #endif
+#else
+ #define PINGPONG_X86 0
+#endif
+
+// GCC and Clang need the instruction set enabled per function; MSVC allows
+// the intrinsics anywhere.
+#if PINGPONG_X86 && (defined (__GNUC__) || defined (__clang__))
+ #define PINGPONG_TARGET(isa) __attribute__ ((target (isa)))
+ #define PINGPONG_HAS_VARIANTS 1
+#elif PINGPONG_X86 && defined (_MSC_VER)
+ #define PINGPONG_TARGET(isa)
+ #define PINGPONG_HAS_VARIANTS 1
+#else
+ #define PINGPONG_HAS_VARIANTS 0
+#endif
+
+//==============================================================================
+// Baseline: plain loops, vectorised by the compiler for the build's own target
+
+static inline float cubicTap (float alpha, float s0, float s1, float s2, float s3)
+{
+    return ( alpha*(alpha-1)*(alpha-2)*s0/(-6)
+           + (alpha-1)*(alpha+1)*(alpha-2)*s1/2
+           + alpha*(alpha+1)*(alpha-2)*s2/(-2)
+           + alpha*(alpha+1)*(alpha-1)*s3/(6) );
+}
+
+static void readTapsBaseline (const float* line, const int* index, const float* alpha, float* dest, int numLanes)
+{
+    for (int l = 0; l < numLanes; ++l)
+    {
+        const float* s = line + (size_t) index[l] * (size_t) numLanes + (size_t) l;
+        dest[l] = cubicTap (alpha[l], s[0], s[numLanes], s[2 * numLanes], s[3 * numLanes]);
+    }
+}
+
+static void mixBaseline (const float* in, const float* wet, const float* factWet, const float* factDry, float* out, int n)
+{
+    for (int i = 0; i < n; ++i)
+        out[i] = (in[i] + wet[i])*factWet[i] + in[i]*factDry[i];
+}
+
+static void smoothBaseline (float* value, const float* target, double coeff, int n)
+{
+    for (int i = 0; i < n; ++i)
+        value[i] = (float) ((1-coeff)*target[i] + coeff*value[i]);
+}
+
+// The peak scan works on the bit patterns with the sign cleared: they order
+// like the magnitudes they encode, and Inf / NaN sort above every finite
+// value, so one unsigned max finds both the peak and any non-finite sample.
+static float peakFromBits (uint32_t bits)
+{
+    if (bits >= 0x7f800000u)
+        return std::numeric_limits<float>::infinity();
+
+    float peak;
+    std::memcpy (&peak, &bits, sizeof (peak));
+    return peak;
+}
+
+static uint32_t maxAbsBits (const float* x, int n)
+{
+    uint32_t m = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        uint32_t bits;
+        std::memcpy (&bits, x + i, sizeof (bits));
+        bits &= 0x7fffffffu;
+        m = bits > m ? bits : m;
+    }
+    return m;
+}
+
+static float peakBaseline (const float* x, int n)
+{
+    return peakFromBits (maxAbsBits (x, n));
+}
+
+#if PINGPONG_HAS_VARIANTS
+//==============================================================================
+// AVX2: hardware gathers for the taps, 8 lanes per instruction
+
+PINGPONG_TARGET ("avx2,fma")
+static inline __m256 cubicTap8 (__m256 a, __m256 s0, __m256 s1, __m256 s2, __m256 s3)
+{
+    const __m256 one = _mm256_set1_ps (1.0f);
+    const __m256 two = _mm256_set1_ps (2.0f);
+    const __m256 am1 = _mm256_sub_ps (a, one);
+    const __m256 am2 = _mm256_sub_ps (a, two);
+    const __m256 ap1 = _mm256_add_ps (a, one);
+
+    __m256 r = _mm256_div_ps (_mm256_mul_ps (_mm256_mul_ps (_mm256_mul_ps (a, am1), am2), s0), _mm256_set1_ps (-6.0f));
+    r = _mm256_add_ps (r, _mm256_div_ps (_mm256_mul_ps (_mm256_mul_ps (_mm256_mul_ps (am1, ap1), am2), s1), two));
+    r = _mm256_add_ps (r, _mm256_div_ps (_mm256_mul_ps (_mm256_mul_ps (_mm256_mul_ps (a, ap1), am2), s2), _mm256_set1_ps (-2.0f)));
+    r = _mm256_add_ps (r, _mm256_div_ps (_mm256_mul_ps (_mm256_mul_ps (_mm256_mul_ps (a, ap1), am1), s3), _mm256_set1_ps (6.0f)));
+    return r;
+}
+
+PINGPONG_TARGET ("avx2,fma")
+static void readTapsAvx2 (const float* line, const int* index, const float* alpha, float* dest, int numLanes)
+{
+    const __m256i stride = _mm256_set1_epi32 (numLanes);
+    const __m256i iota = _mm256_setr_epi32 (0, 1, 2, 3, 4, 5, 6, 7);
+    int l = 0;
+
+    for (; l + 8 <= numLanes; l += 8)
+    {
+        const __m256i frames = _mm256_loadu_si256 (reinterpret_cast<const __m256i*> (index + l));
+        const __m256i offsets = _mm256_add_epi32 (_mm256_mullo_epi32 (frames, stride),
+                                                  _mm256_add_epi32 (iota, _mm256_set1_epi32 (l)));
+
+        const __m256 s0 = _mm256_i32gather_ps (line, offsets, 4);
+        const __m256 s1 = _mm256_i32gather_ps (line + numLanes, offsets, 4);
+        const __m256 s2 = _mm256_i32gather_ps (line + 2 * numLanes, offsets, 4);
+        const __m256 s3 = _mm256_i32gather_ps (line + 3 * numLanes, offsets, 4);
+
+        _mm256_storeu_ps (dest + l, cubicTap8 (_mm256_loadu_ps (alpha + l), s0, s1, s2, s3));
+    }
+
+    // Fewer than 8 lanes left: a 128-bit gather doesn't beat plain loads
+    for (; l < numLanes; ++l)
+    {
+        const float* s = line + (size_t) index[l] * (size_t) numLanes + (size_t) l;
+        dest[l] = cubicTap (alpha[l], s[0], s[numLanes], s[2 * numLanes], s[3 * numLanes]);
+    }
+}
+
+PINGPONG_TARGET ("avx2,fma")
+static void mixAvx2 (const float* in, const float* wet, const float* factWet, const float* factDry, float* out, int n)
+{
+    int i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        const __m256 x = _mm256_loadu_ps (in + i);
+        const __m256 w = _mm256_add_ps (x, _mm256_loadu_ps (wet + i));
+        _mm256_storeu_ps (out + i, _mm256_add_ps (_mm256_mul_ps (w, _mm256_loadu_ps (factWet + i)),
+                                                  _mm256_mul_ps (x, _mm256_loadu_ps (factDry + i))));
+    }
+
+    mixBaseline (in + i, wet + i, factWet + i, factDry + i, out + i, n - i);
+}
+
+PINGPONG_TARGET ("avx2,fma")
+static void smoothAvx2 (float* value, const float* target, double coeff, int n)
+{
+    const __m256d c = _mm256_set1_pd (coeff);
+    const __m256d oneMinusC = _mm256_set1_pd (1 - coeff);
+    int i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+        const __m256d t = _mm256_cvtps_pd (_mm_loadu_ps (target + i));
+        const __m256d v = _mm256_cvtps_pd (_mm_loadu_ps (value + i));
+        _mm_storeu_ps (value + i, _mm256_cvtpd_ps (_mm256_add_pd (_mm256_mul_pd (oneMinusC, t), _mm256_mul_pd (c, v))));
+    }
+
+    smoothBaseline (value + i, target + i, coeff, n - i);
+}
+
+PINGPONG_TARGET ("avx2,fma")
+static float peakAvx2 (const float* x, int n)
+{
+    const __m256i absMask = _mm256_set1_epi32 (0x7fffffff);
+    __m256i m = _mm256_setzero_si256();
+    int i = 0;
+
+    for (; i + 8 <= n; i += 8)
+        m = _mm256_max_epu32 (m, _mm256_and_si256 (_mm256_loadu_si256 (reinterpret_cast<const __m256i*> (x + i)), absMask));
+
+    alignas (32) uint32_t lanes[8];
+    _mm256_store_si256 (reinterpret_cast<__m256i*> (lanes), m);
+
+    uint32_t bits = maxAbsBits (x + i, n - i);
+    for (auto lane : lanes)
+        bits = lane > bits ? lane : bits;
+
+    return peakFromBits (bits);
+}
+
+//==============================================================================
+// AVX-512: 16 lanes per gather
+
+PINGPONG_TARGET ("avx512f")
+static void readTapsAvx512 (const float* line, const int* index, const float* alpha, float* dest, int numLanes)
+{
+    const __m512i stride = _mm512_set1_epi32 (numLanes);
+    const __m512i iota = _mm512_setr_epi32 (0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    const __m512 one = _mm512_set1_ps (1.0f);
+    const __m512 two = _mm512_set1_ps (2.0f);
+    const __m512 zero = _mm512_setzero_ps();
+    const __mmask16 all = 0xffff;
+    int l = 0;
+
+    for (; l + 16 <= numLanes; l += 16)
+    {
+        const __m512i frames = _mm512_loadu_si512 (index + l);
+        const __m512i offsets = _mm512_add_epi32 (_mm512_mullo_epi32 (frames, stride),
+                                                  _mm512_add_epi32 (iota, _mm512_set1_epi32 (l)));
+
+        // The masked gathers with a zeroed source: GCC's plain ones start from
+        // an undefined vector and warn about it
+        const __m512 s0 = _mm512_mask_i32gather_ps (zero, all, offsets, line, 4);
+        const __m512 s1 = _mm512_mask_i32gather_ps (zero, all, offsets, line + numLanes, 4);
+        const __m512 s2 = _mm512_mask_i32gather_ps (zero, all, offsets, line + 2 * numLanes, 4);
+        const __m512 s3 = _mm512_mask_i32gather_ps (zero, all, offsets, line + 3 * numLanes, 4);
+
+        const __m512 a = _mm512_loadu_ps (alpha + l);
+        const __m512 am1 = _mm512_sub_ps (a, one);
+        const __m512 am2 = _mm512_sub_ps (a, two);
+        const __m512 ap1 = _mm512_add_ps (a, one);
+
+        __m512 r = _mm512_div_ps (_mm512_mul_ps (_mm512_mul_ps (_mm512_mul_ps (a, am1), am2), s0), _mm512_set1_ps (-6.0f));
+        r = _mm512_add_ps (r, _mm512_div_ps (_mm512_mul_ps (_mm512_mul_ps (_mm512_mul_ps (am1, ap1), am2), s1), two));
+        r = _mm512_add_ps (r, _mm512_div_ps (_mm512_mul_ps (_mm512_mul_ps (_mm512_mul_ps (a, ap1), am2), s2), _mm512_set1_ps (-2.0f)));
+        r = _mm512_add_ps (r, _mm512_div_ps (_mm512_mul_ps (_mm512_mul_ps (_mm512_mul_ps (a, ap1), am1), s3), _mm512_set1_ps (6.0f)));
+
+        _mm512_storeu_ps (dest + l, r);
+    }
+
+    // 4 or 8 lanes: the AVX2 gathers are as good
+    if (l < numLanes)
+        readTapsAvx2 (line, index, alpha, dest, numLanes);
+}
+
+PINGPONG_TARGET ("avx512f")
+static void mixAvx512 (const float* in, const float* wet, const float* factWet, const float* factDry, float* out, int n)
+{
+    int i = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+        const __m512 x = _mm512_loadu_ps (in + i);
+        const __m512 w = _mm512_add_ps (x, _mm512_loadu_ps (wet + i));
+        _mm512_storeu_ps (out + i, _mm512_add_ps (_mm512_mul_ps (w, _mm512_loadu_ps (factWet + i)),
+                                                  _mm512_mul_ps (x, _mm512_loadu_ps (factDry + i))));
+    }
+
+    mixAvx2 (in + i, wet + i, factWet + i, factDry + i, out + i, n - i);
+}
+
+PINGPONG_TARGET ("avx512f")
+static void smoothAvx512 (float* value, const float* target, double coeff, int n)
+{
+    const __m512d c = _mm512_set1_pd (coeff);
+    const __m512d oneMinusC = _mm512_set1_pd (1 - coeff);
+    const __mmask8 all = 0xff;
+    int i = 0;
+
+    // Zero-masked conversions, all lanes on: the same instructions without
+    // the undefined source GCC warns about
+    for (; i + 8 <= n; i += 8)
+    {
+        const __m512d t = _mm512_maskz_cvtps_pd (all, _mm256_loadu_ps (target + i));
+        const __m512d v = _mm512_maskz_cvtps_pd (all, _mm256_loadu_ps (value + i));
+        _mm256_storeu_ps (value + i, _mm512_maskz_cvtpd_ps (all, _mm512_add_pd (_mm512_mul_pd (oneMinusC, t), _mm512_mul_pd (c, v))));
+    }
+
+    smoothAvx2 (value + i, target + i, coeff, n - i);
+}
+
+PINGPONG_TARGET ("avx512f")
+static float peakAvx512 (const float* x, int n)
+{
+    const __m512i absMask = _mm512_set1_epi32 (0x7fffffff);
+    const __mmask16 all = 0xffff;
+    __m512i m = _mm512_setzero_si512();
+    int i = 0;
+
+    // As in peakAvx2; _mm512_max_epu32 and _mm512_reduce_max_epu32 start
+    // from undefined vectors that GCC warns about
+    for (; i + 16 <= n; i += 16)
+        m = _mm512_maskz_max_epu32 (all, m, _mm512_and_si512 (_mm512_loadu_si512 (x + i), absMask));
+
+    alignas (64) uint32_t lanes[16];
+    _mm512_store_si512 (lanes, m);
+
+    uint32_t bits = maxAbsBits (x + i, n - i);
+    for (auto lane : lanes)
+        bits = lane > bits ? lane : bits;
+
+    return peakFromBits (bits);
+}
+#endif
+
+//==============================================================================
+static const PingPongKernels kernelTable[] =
+{
+    { readTapsBaseline, mixBaseline, smoothBaseline, peakBaseline, PingPongSimdLevel::baseline, PINGPONG_X86 ? "sse2" : "baseline", false },
+   #if PINGPONG_HAS_VARIANTS
+    { readTapsAvx2,     mixAvx2,     smoothAvx2,     peakAvx2,     PingPongSimdLevel::avx2,     "avx2",   true },
+    { readTapsAvx512,   mixAvx512,   smoothAvx512,   peakAvx512,   PingPongSimdLevel::avx512,   "avx512", true },
+   #endif
+};
+
+static PingPongSimdLevel detectSimdLevel()
+{
+   #if PINGPONG_HAS_VARIANTS
+    #if defined (_MSC_VER) && ! defined (__clang__)
+     int info[4];
+     __cpuid (info, 0);
+     const int maxLeaf = info[0];
+
+     __cpuid (info, 1);
+     const bool osxsave = (info[2] & (1 << 27)) != 0;
+     const bool fma = (info[2] & (1 << 12)) != 0;
+     const bool f16c = (info[2] & (1 << 29)) != 0;
+     const unsigned long long xcr0 = osxsave ? _xgetbv (0) : 0;
+     const bool ymmState = (xcr0 & 0x6) == 0x6;
+     const bool zmmState = (xcr0 & 0xe6) == 0xe6;
+
+     bool avx2 = false, avx512f = false;
+     if (maxLeaf >= 7)
+     {
+         __cpuidex (info, 7, 0);
+         avx2 = (info[1] & (1 << 5)) != 0;
+         avx512f = (info[1] & (1 << 16)) != 0;
+     }
+
+     if (avx512f && f16c && zmmState)
+         return PingPongSimdLevel::avx512;
+     if (avx2 && fma && f16c && ymmState)
+         return PingPongSimdLevel::avx2;
+    #else
+     // These check the OS saves the wide registers as well
+     __builtin_cpu_init();
+
+     const bool f16c = __builtin_cpu_supports ("f16c");
+
+     if (__builtin_cpu_supports ("avx512f") && f16c)
+         return PingPongSimdLevel::avx512;
+     if (__builtin_cpu_supports ("avx2") && __builtin_cpu_supports ("fma") && f16c)
+         return PingPongSimdLevel::avx2;
+    #endif
+   #endif
+
+    return PingPongSimdLevel::baseline;
+}
+
+// PINGPONG_SIMD=sse2|avx2|avx512 caps the automatic choice, e.g. for benchmarks
+static PingPongSimdLevel getAutomaticSimdLevel()
+{
+    static const PingPongSimdLevel level = []
+    {
+        auto detected = detectSimdLevel();
+
+        if (const char* env = std::getenv ("PINGPONG_SIMD"))
+        {
+            auto requested = detected;
+
+            if (std::strcmp (env, "sse2") == 0 || std::strcmp (env, "baseline") == 0)  requested = PingPongSimdLevel::baseline;
+            else if (std::strcmp (env, "avx2") == 0)                                    requested = PingPongSimdLevel::avx2;
+            else if (std::strcmp (env, "avx512") == 0)                                  requested = PingPongSimdLevel::avx512;
+
+            if ((int) requested < (int) detected)
+                detected = requested;
+        }
+
+        return detected;
+    }();
+
+    return level;
+}
+
+static std::atomic<int> forcedSimdLevel { -1 };
+
+//==============================================================================
+PingPongSimdLevel getSupportedPingPongSimdLevel()
+{
+    static const PingPongSimdLevel level = detectSimdLevel();
+    return level;
+}
+
+const PingPongKernels& getPingPongKernels (PingPongSimdLevel level)
+{
+    int index = (int) level;
+
+    if (index > (int) getSupportedPingPongSimdLevel())
+        index = (int) getSupportedPingPongSimdLevel();
+
+    return kernelTable[index];
+}
+
+const PingPongKernels& getPingPongKernels()
+{
+    const int forced = forcedSimdLevel.load (std::memory_order_relaxed);
+
+    return getPingPongKernels (forced >= 0 ? (PingPongSimdLevel) forced : getAutomaticSimdLevel());
+}
+
+PingPongSimdLevel forcePingPongSimdLevel (PingPongSimdLevel level)
+{
+    const auto used = getPingPongKernels (level).level;
+    forcedSimdLevel.store ((int) used);
+    return used;
+}
+
+void resetPingPongSimdLevel()
+{
+    forcedSimdLevel.store (-1);
+}
@@ -0,0 +1,75 @@
+/*
+  ==============================================================================
+
+    PingPongKernels.h
+    The vectorisable inner loops, built for several instruction sets and
+    picked at runtime.
+
+    One binary has to run on anything from an SSE2-only machine to an
+    AVX-512 server, so the loops that work across many values at once are
+    compiled once per instruction set and the best one the CPU supports is
+    chosen on first use (cpuid). These are the loops of PingPongBatch, which
+    runs many delays side by side: the gathered cubic taps, the dry/wet
+    and volume mix and the delay time smoothing. The single-instance engine
+    is a recurrence from one sample to the next with nothing to put side by
+    side, so it stays on the baseline build; it only uses the block peak
+    scan from here, for its output guard and the ducking's sidechain, and
+    asks whether its float16 histories can convert with F16C.
+
+    For benchmarking, or to check the variants against each other, a level
+    can be forced with forcePingPongSimdLevel() or, for a whole host
+    process, the PINGPONG_SIMD environment variable ("sse2", "avx2" or
+    "avx512"). getPingPongKernels (level) returns any one variant directly.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+//==============================================================================
+enum class PingPongSimdLevel
+{
+    baseline = 0,   // whatever the build targets: SSE2 on x86-64, NEON on ARM
+    avx2,           // AVX2 + FMA (+ F16C, which every AVX2 CPU has)
+    avx512          // AVX-512F
+};
+
+struct PingPongKernels
+{
+    // Cubic Lagrange taps of numLanes independent delays whose lines are
+    // interleaved by lane (numLanes floats per frame). Lane l reads frames
+    // index[l] .. index[l] + 3 and interpolates at alpha[l].
+    void (*readTaps) (const float* line, const int* index, const float* alpha, float* dest, int numLanes);
+
+    // out = (in + wet) * factWet + in * factDry
+    void (*mix) (const float* in, const float* wet, const float* factWet, const float* factDry, float* out, int n);
+
+    // One step of the delay time smoothing: value = (1 - coeff) * target + coeff * value,
+    // worked out in double like the engine does
+    void (*smooth) (float* value, const float* target, double coeff, int n);
+
+    // Largest |x[i]|, or infinity if any sample is NaN or infinite
+    float (*peak) (const float* x, int n);
+
+    PingPongSimdLevel level;
+    const char* name;
+
+    // The float16 delay histories can use Float16F16CStorage
+    bool f16c;
+};
+
+// Highest level this CPU (and this build) supports
+PingPongSimdLevel getSupportedPingPongSimdLevel();
+
+// The variant in use: the supported level, or a forced one
+const PingPongKernels& getPingPongKernels();
+
+// One specific variant. Falls back to the best supported level below it.
+const PingPongKernels& getPingPongKernels (PingPongSimdLevel level);
+
+// Makes getPingPongKernels() return this level (clamped to what is supported)
+// from now on. Returns the level actually used. Not for the audio thread.
+PingPongSimdLevel forcePingPongSimdLevel (PingPongSimdLevel level);
+
+// Back to automatic selection
+void resetPingPongSimdLevel();
@@ -0,0 +1,56 @@
+/*
+  ==============================================================================
+
+    PingPongParameters.h
+    The settings of one ping-pong delay, as the engine and the batch take
+    them.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "DelayTimeModes.h"
+#include "TapInterpolation.h"
+#include "FeedbackMatrix.h"
+#include "ShimmerHeads.h"
+
+//==============================================================================
+struct PingPongParameters
+{
+    float delayL = 0;       // ms
+    float delayR = 0;       // ms
+    float feedbackL = 0;    // 0 .. 1
+    float feedbackR = 0;    // 0 .. 1
+    float dryWet = 1;       // 0 = dry .. 1 = wet
+    float volumeDb = 0;
+    DelayTimeMode timeMode = DelayTimeMode::jump;
+    float fadeMs = 200;     // Fade mode crossfade length
+    float tapeRate = 0.5f;  // Tape mode, max delay change in s per s
+    bool freeze = false;
+    bool softLimit = false; // soft limiter in the feedback path and on the output
+    TapQuality tapQuality = TapQuality::cubic;
+    int fdnLines = 2;       // 2 = ping-pong, or an FDN of 4, 8 or 16 lines
+    FeedbackMatrixType fdnMatrix = FeedbackMatrixType::hadamard;
+    float diffusion = 0;    // 0 .. 1, allpass smearing of the ping-pong's repeats
+    float shimmer = 0;      // 0 .. 1, how much of the ping-pong's feedback is pitched up
+    ShimmerInterval shimmerInterval = ShimmerInterval::octave;
+    bool reverse = false;   // the ping-pong's input played backwards, a delay-length segment at a time
+    float drive = 0;        // 0 .. 1, saturation of the ping-pong's feedback
+
+    // Multiband: the ping-pong split into 2 or 3 bands (1 = off), each with
+    // its own delay (both sides) and feedback. Low, mid, high; the mid band's
+    // settings only count with 3 bands.
+    int bands = 1;
+    float crossoverLowHz = 250;
+    float crossoverHighHz = 2500;
+    float bandDelayMs[3] = { 450, 300, 150 };
+    float bandFeedback[3] = { 0.5f, 0.5f, 0.5f };
+
+    // Ducking: the repeats turned down while the sidechain is above the
+    // threshold (only with a sidechain, see PingPongEngine::setSidechain())
+    float duckAmount = 0;       // 0 .. 1, 1 mutes them
+    float duckAttackMs = 10;
+    float duckReleaseMs = 250;
+    float duckThresholdDb = -30;
+};
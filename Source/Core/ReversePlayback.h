@@ -0,0 +1,125 @@
+/*
+  ==============================================================================
+
+    ReversePlayback.h
+    Reverse: the input history of one side played backwards, one delay-length
+    segment at a time, to feed the ping-pong in place of the forward tap.
+
+    While one segment plays, the next is being written: each starts at the
+    newest sample a little behind the read head and runs back over the
+    segment's length, so a sample j into it is 2j + 1 + LAG samples old. The
+    reads go a block at a time through the lines' readBackwards(), a
+    reversed bulk copy, rather than one interpolated tap per sample.
+
+    At a boundary the old segment carries on backwards for a short fade
+    while the new one comes in (sin^2 / cos^2, from the Shimmer window
+    table), so the jump back doesn't click. Segments reach back twice their
+    length: the engine caps them at half of what the lines hold.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <algorithm>
+#include "ShimmerHeads.h"
+
+//==============================================================================
+class ReversePlayback
+{
+public:
+    static constexpr int CHUNK = 64;        // samples rendered at a time
+    static constexpr int LAG = CHUNK;       // newest sample a segment starts on, behind the read head
+    static constexpr float FADE_MS = 10.0f; // segment boundary crossfade
+
+    void prepare (double sampleRate) noexcept
+    {
+        fadeSamples = std::max (1, (int) (FADE_MS * sampleRate / 1000));
+        reset();
+    }
+
+    // The next render() starts a segment, faded in from silence
+    void reset() noexcept
+    {
+        segmentLength = 0;
+        index = 0;
+        fadeIndex = fadeLength = 0;
+        fadingFromSilence = true;
+    }
+
+    // Longest segment whose reads stay within maxDelay samples of the read head
+    int getMaxSegment (int maxDelay) const noexcept
+    {
+        return std::max (1, (maxDelay - LAG - fadeSamples) / 2 - 1);
+    }
+
+    // The next numSamples (up to CHUNK) of the line played backwards. newest
+    // is the read head's position minus LAG at the first of them; segments
+    // starting in between are length samples long.
+    template <typename Lines>
+    void render (const Lines& lines, int line, int newest, int length, int numSamples, float* dest) noexcept
+    {
+        const int size = lines.getSize();
+        const auto& window = ShimmerWindow::get();
+
+        for (int k = 0; k < numSamples;)
+        {
+            if (index >= segmentLength)
+                startSegment (wrap (newest + k + 1, size), length);
+
+            const int run = std::min (numSamples - k, segmentLength - index);
+            lines.readBackwards (line, wrap (segmentEnd - 1 - index, size), run, dest + k);
+
+            if (fadeIndex < fadeLength)
+            {
+                const int n = std::min (run, fadeLength - fadeIndex);
+                float old[CHUNK];
+
+                if (fadingFromSilence)
+                    std::fill (old, old + n, 0.0f);
+                else
+                    lines.readBackwards (line, wrap (oldEnd - 1 - oldIndex, size), n, old);
+
+                for (int f = 0; f < n; ++f)
+                {
+                    const float g = window.at (0.5f * (float) (fadeIndex + f + 1) / (float) (fadeLength + 1));
+                    dest[k + f] = g*dest[k + f] + (1 - g)*old[f];
+                }
+
+                fadeIndex += n;
+                oldIndex += n;
+            }
+
+            index += run;
+            k += run;
+        }
+    }
+
+private:
+    void startSegment (int end, int length) noexcept
+    {
+        // The one playing carries on under the fade
+        fadingFromSilence = segmentLength == 0;
+        oldEnd = segmentEnd;
+        oldIndex = index;
+
+        segmentEnd = end;
+        segmentLength = std::max (length, 1);
+        index = 0;
+        fadeLength = std::min (fadeSamples, segmentLength / 2);
+        fadeIndex = 0;
+    }
+
+    static int wrap (int pos, int size) noexcept
+    {
+        pos %= size;
+        return pos < 0 ? pos + size : pos;
+    }
+
+    int fadeSamples = 441;
+
+    int segmentEnd = 0, segmentLength = 0, index = 0;   // plays segmentEnd - 1 - index
+    int oldEnd = 0, oldIndex = 0;                       // the previous one, under the fade
+    int fadeIndex = 0, fadeLength = 0;
+    bool fadingFromSilence = true;
+};
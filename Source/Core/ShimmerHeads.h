@@ -0,0 +1,134 @@
+/*
+  ==============================================================================
+
+    ShimmerHeads.h
+    Shimmer: the repeats pitched up by an octave or a fifth inside the
+    feedback loop, so every trip round climbs one interval higher.
+
+    The shifter has no buffer of its own. It is two extra read heads on the
+    cross-feedback history the plain tap already reads: each head moves
+    through the history faster than the write head, ratio - 1 samples of
+    delay per sample, over a window of WINDOW_MS around the tap, and jumps
+    back to the far end of the window when it gets to the near one. The
+    two heads are half a window apart and crossfaded with a sin^2 window
+    that is 0 at the jump, so their gains always sum to 1.
+
+    On average the heads sit on the tap itself, so the shifted repeats stay
+    on time, but they reach half a window either side of it: the delay has
+    to be at least WINDOW_MS / 2 long.
+
+    The window is a table built once and looked up in prepare(); per
+    sample the heads cost a phase step and a table read. In the engine each
+    repeat reads both heads, besides the plain tap until Shimmer is all the
+    way up, so a settled Shimmer makes the cubic ping-pong about 1.5 times
+    as expensive.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cmath>
+#include <algorithm>
+
+//==============================================================================
+enum class ShimmerInterval
+{
+    octave = 0,
+    fifth
+};
+
+inline const char* getShimmerIntervalName (ShimmerInterval interval) noexcept
+{
+    return interval == ShimmerInterval::fifth ? "Fifth" : "Octave";
+}
+
+inline double getShimmerRatio (ShimmerInterval interval) noexcept
+{
+    return interval == ShimmerInterval::fifth ? 1.4983070768766815 : 2.0;   // 2^(7/12), 2
+}
+
+//==============================================================================
+// sin^2 over one window, 0 at both ends
+struct ShimmerWindow
+{
+    static constexpr int POINTS = 512;
+
+    float gains[POINTS + 1];
+
+    ShimmerWindow() noexcept
+    {
+        for (int i = 0; i <= POINTS; ++i)
+        {
+            const double s = std::sin (3.141592653589793 * i / POINTS);
+            gains[i] = (float) (s * s);
+        }
+    }
+
+    static const ShimmerWindow& get() noexcept
+    {
+        static const ShimmerWindow table;
+        return table;
+    }
+
+    // phase 0 .. 1
+    float at (float phase) const noexcept
+    {
+        const float position = phase * POINTS;
+        const int i = std::min ((int) position, POINTS - 1);
+        return gains[i] + (position - (float) i) * (gains[i + 1] - gains[i]);
+    }
+};
+
+//==============================================================================
+class ShimmerHeads
+{
+public:
+    static constexpr float WINDOW_MS = 40.0f;
+
+    // Window length for the rate the network runs at. Starts the heads over.
+    void prepare (double sampleRate) noexcept
+    {
+        windowSamples = (float) (WINDOW_MS * sampleRate / 1000);
+        window = &ShimmerWindow::get();
+
+        setInterval (interval);
+        reset();
+    }
+
+    void setInterval (ShimmerInterval newInterval) noexcept
+    {
+        interval = newInterval;
+        phaseStep = (float) ((getShimmerRatio (interval) - 1) / windowSamples);
+    }
+
+    void reset() noexcept { phase = 0; }
+
+    // How far the heads reach either side of the tap, in samples
+    float getReach() const noexcept { return 0.5f * windowSamples; }
+
+    // Once per sample: where the two heads are (samples of delay on top of
+    // the tap's, negative = less delayed) and their gains
+    void advance() noexcept
+    {
+        if ((phase += phaseStep) >= 1.0f)
+            phase -= 1.0f;
+
+        const float other = phase < 0.5f ? phase + 0.5f : phase - 0.5f;
+
+        offset[0] = windowSamples * (0.5f - phase);
+        offset[1] = windowSamples * (0.5f - other);
+        gain[0] = window->at (phase);
+        gain[1] = 1 - gain[0];
+    }
+
+    float offset[2] = { 0, 0 };
+    float gain[2] = { 0, 1 };
+
+private:
+    const ShimmerWindow* window = nullptr;     // looked up in prepare(), not per sample
+    ShimmerInterval interval = ShimmerInterval::octave;
+    float windowSamples = 1764;
+    float phaseStep = 0;
+    float phase = 0;
+};
@@ -0,0 +1,114 @@
+/*
+  ==============================================================================
+
+    SidechainDucker.h
+    Ducking: the repeats turned down while a sidechain signal (a vocal, a
+    lead) is above a threshold, and brought back up when it stops.
+
+    The detector works a SEGMENT of samples at a time: one SIMD peak scan
+    of both sidechain channels (the kernels' peak, as for the output guard)
+    gives the segment's level, which goes through a soft knee into a target
+    gain. The gain follows the target with the attack or the release time,
+    one step per segment, and is ramped linearly across the segment, so the
+    per-sample work is a multiply-add into the gain curve the engine's mix
+    then applies to the echoes.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cmath>
+#include <algorithm>
+#include "PingPongKernels.h"
+
+//==============================================================================
+class SidechainDucker
+{
+public:
+    static constexpr int SEGMENT = 32;          // samples per detector step
+    static constexpr float KNEE_DB = 6.0f;      // full depth this far above the threshold
+
+    void prepare (double sampleRate) noexcept
+    {
+        rate = sampleRate;
+        attackMs = releaseMs = -1;  // coefficients again on the next setParameters()
+        reset();
+    }
+
+    // amount 0 .. 1 is the depth (1 mutes the repeats); attack and release in ms
+    void setParameters (float amount, float attack, float release, float thresholdDb) noexcept
+    {
+        depth = std::min (std::max (amount, 0.0f), 1.0f);
+        threshold = thresholdDb;
+
+        if (attack != attackMs || release != releaseMs)
+        {
+            attackMs = attack;
+            releaseMs = release;
+            attackCoeff = getSegmentCoeff (attack);
+            releaseCoeff = getSegmentCoeff (release);
+        }
+    }
+
+    void reset() noexcept { gain = 1; }
+
+    // Back at 1: nothing left to release
+    bool isReleased() const noexcept { return gain >= 1; }
+
+    // Nothing to do while released and nothing asks for ducking
+    bool isIdle() const noexcept { return depth <= 0 && isReleased(); }
+
+    // The gain curve for numSamples of the sidechain into gains; nullptr
+    // sides count as silence
+    void process (const float* left, const float* right, int numSamples, float* gains) noexcept
+    {
+        const auto& kernels = getPingPongKernels();
+
+        for (int start = 0; start < numSamples; start += SEGMENT)
+        {
+            const int n = std::min (SEGMENT, numSamples - start);
+
+            float peak = 0;
+            if (left != nullptr)
+                peak = kernels.peak (left + start, n);
+            if (right != nullptr)
+                peak = std::max (peak, kernels.peak (right + start, n));
+
+            float target = 1;
+            if (depth > 0 && peak > 0)
+            {
+                const float over = 20 * std::log10 (std::min (peak, 1.0e6f)) - threshold;
+                target = 1 - depth * std::min (std::max (over / KNEE_DB, 0.0f), 1.0f);
+            }
+
+            const float coeff = target < gain ? attackCoeff : releaseCoeff;
+            float next = target + coeff * (gain - target);
+            if (std::fabs (next - 1) < 1.0e-5f && target >= 1)
+                next = 1;      // settles, so isIdle() can take it out again
+
+            // The step spread over the segment (for a short one, its share)
+            const float step = (next - gain) / (float) SEGMENT;
+            for (int i = 0; i < n; ++i)
+                gains[start + i] = gain + step * (float) (i + 1);
+
+            gain += step * (float) n;
+            if (n == SEGMENT)
+                gain = next;
+        }
+    }
+
+private:
+    // One-pole coefficient for a SEGMENT-sample step at the given time constant
+    float getSegmentCoeff (float ms) const noexcept
+    {
+        const double samples = std::max ((double) ms, 0.1) * rate / 1000;
+        return (float) std::exp (-SEGMENT / samples);
+    }
+
+    double rate = 44100;
+    float depth = 0, threshold = -20;
+    float attackMs = -1, releaseMs = -1;
+    float attackCoeff = 0, releaseCoeff = 0;
+    float gain = 1;
+};
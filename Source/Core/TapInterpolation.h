@@ -0,0 +1,139 @@
+/*
+  ==============================================================================
+
+    TapInterpolation.h
+    Interpolation orders for the fractional delay taps.
+
+    Cubic Lagrange is the engine's own and the default. Linear costs a
+    fraction of it and is what the plugin drops to when a block gets close
+    to its deadline. For offline renders there is a 16-point windowed sinc,
+    flat to about 0.9 of Nyquist, read from a polyphase table (256 phases,
+    linearly interpolated between them) built once.
+
+    A change of order is crossfaded: for a short stretch the taps are read
+    with both and mixed, so the switch doesn't click.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cmath>
+
+//==============================================================================
+enum class TapQuality
+{
+    linear = 0,
+    cubic,
+    sinc
+};
+
+inline const char* getTapQualityName (TapQuality quality) noexcept
+{
+    switch (quality)
+    {
+        case TapQuality::linear: return "linear";
+        case TapQuality::sinc:   return "sinc";
+        default:                 return "cubic";
+    }
+}
+
+//==============================================================================
+struct SincTable
+{
+    static constexpr int POINTS = 16;          // taps -7 .. 8 around the read position
+    static constexpr int FIRST = -(POINTS/2 - 1);
+    static constexpr int PHASES = 256;
+
+    float weights[PHASES + 1][POINTS];
+
+    SincTable() noexcept
+    {
+        const double cutoff = 0.9;              // of Nyquist
+        const double beta = 8.0;
+        const double halfWidth = POINTS / 2;
+
+        for (int p = 0; p <= PHASES; ++p)
+        {
+            const double phase = (double) p / PHASES;
+            double sum = 0;
+
+            for (int j = 0; j < POINTS; ++j)
+            {
+                const double x = (FIRST + j) - phase;
+                const double w = x / halfWidth;
+                const double window = std::abs (w) < 1 ? besselI0 (beta * std::sqrt (1 - w*w)) / besselI0 (beta) : 0;
+                const double arg = 3.141592653589793 * cutoff * x;
+                const double sinc = x == 0 ? cutoff : std::sin (arg) / (3.141592653589793 * x);
+
+                weights[p][j] = (float) (sinc * window);
+                sum += weights[p][j];
+            }
+
+            // Unity gain at DC for every phase
+            for (auto& weight : weights[p])
+                weight = (float) (weight / sum);
+        }
+    }
+
+    static const SincTable& get() noexcept
+    {
+        static const SincTable table;
+        return table;
+    }
+
+private:
+    static double besselI0 (double x) noexcept
+    {
+        double sum = 1, term = 1;
+        for (int i = 1; i < 30; ++i)
+        {
+            term *= (x / (2*i)) * (x / (2*i));
+            sum += term;
+        }
+        return sum;
+    }
+};
+
+//==============================================================================
+// Which order the taps use, and the crossfade from the previous one
+struct TapInterpolator
+{
+    TapQuality quality = TapQuality::cubic;
+    TapQuality previous = TapQuality::cubic;
+    float mix = 1;          // weight of quality against previous
+    float mixStep = 0;
+    bool fading = false;
+
+    void reset (TapQuality q) noexcept
+    {
+        quality = previous = q;
+        mix = 1;
+        fading = false;
+    }
+
+    void setQuality (TapQuality q, int fadeSamples) noexcept
+    {
+        if (q == quality)
+            return;
+
+        // A change during a fade starts over from whichever order was ahead
+        previous = (fading && mix < 0.5f) ? previous : quality;
+        quality = q;
+        mix = 0;
+        mixStep = 1.0f / (float) (fadeSamples > 1 ? fadeSamples : 1);
+        fading = true;
+    }
+
+    // Once per sample
+    void advance() noexcept
+    {
+        if (fading && (mix += mixStep) >= 1.0f)
+        {
+            mix = 1;
+            fading = false;
+        }
+    }
+
+    bool isPlainCubic() const noexcept { return quality == TapQuality::cubic && ! fading; }
+};
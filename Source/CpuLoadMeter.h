@@ -0,0 +1,162 @@
+/*
+  ==============================================================================
+
+    CpuLoadMeter.h
+    Measures how long each processBlock call takes relative to the real-time
+    budget of the block (numSamples / sampleRate).
+
+    The audio thread only ever does relaxed atomic increments, so the editor
+    (or a host integration) can read the statistics at any time without locks.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+
+//==============================================================================
+struct CpuLoadStats
+{
+    float lastLoad = 0;     // load of the most recent block (1.0 = whole budget used)
+    float p50 = 0;          // median block load
+    float p99 = 0;          // 99th percentile block load
+    float max = 0;          // worst block load seen since the last reset
+    juce::uint64 numBlocks = 0;
+    juce::uint64 deadlineMisses = 0; // blocks that took longer than their budget
+};
+
+//==============================================================================
+class CpuLoadMeter
+{
+public:
+    // Histogram covers 0 .. MAX_LOAD times the block budget; anything above
+    // lands in the last bin.
+    static constexpr int NUM_BINS = 128;
+    static constexpr float MAX_LOAD = 2.0f;
+
+    void prepare (double sampleRate)
+    {
+        gTicksPerSample = (double) juce::Time::getHighResolutionTicksPerSecond() / sampleRate;
+        reset();
+    }
+
+    void reset()
+    {
+        for (auto& bin : histogram)
+            bin.store (0, std::memory_order_relaxed);
+
+        lastLoad.store (0, std::memory_order_relaxed);
+        maxLoad.store (0, std::memory_order_relaxed);
+        numBlocks.store (0, std::memory_order_relaxed);
+        deadlineMisses.store (0, std::memory_order_relaxed);
+    }
+
+    // Called from the audio thread at the end of every block.
+    void addMeasurement (juce::int64 elapsedTicks, int numSamples)
+    {
+        if (numSamples <= 0 || gTicksPerSample <= 0)
+            return;
+
+        const float load = (float) ((double) elapsedTicks / (gTicksPerSample * numSamples));
+
+        int bin = (int) (load * (NUM_BINS / MAX_LOAD));
+        if (bin >= NUM_BINS)
+            bin = NUM_BINS - 1;
+        else if (bin < 0)
+            bin = 0;
+
+        histogram[bin].fetch_add (1, std::memory_order_relaxed);
+        numBlocks.fetch_add (1, std::memory_order_relaxed);
+
+        if (load > 1.0f)
+            deadlineMisses.fetch_add (1, std::memory_order_relaxed);
+
+        lastLoad.store (load, std::memory_order_relaxed);
+
+        // only the audio thread writes maxLoad, so no compare-exchange needed
+        if (load > maxLoad.load (std::memory_order_relaxed))
+            maxLoad.store (load, std::memory_order_relaxed);
+    }
+
+    // Safe to call from any thread.
+    CpuLoadStats getStats() const
+    {
+        CpuLoadStats stats;
+        stats.lastLoad = lastLoad.load (std::memory_order_relaxed);
+        stats.max = maxLoad.load (std::memory_order_relaxed);
+        stats.numBlocks = numBlocks.load (std::memory_order_relaxed);
+        stats.deadlineMisses = deadlineMisses.load (std::memory_order_relaxed);
+
+        std::array<juce::uint32, NUM_BINS> counts;
+        juce::uint64 total = 0;
+        for (int i = 0; i < NUM_BINS; ++i)
+        {
+            counts[i] = histogram[i].load (std::memory_order_relaxed);
+            total += counts[i];
+        }
+
+        stats.p50 = percentileFromCounts (counts, total, 0.50);
+        stats.p99 = percentileFromCounts (counts, total, 0.99);
+        return stats;
+    }
+
+    // Load of the most recent block, cheap enough to poll every block.
+    float getLastLoad() const { return lastLoad.load (std::memory_order_relaxed); }
+
+    // Copies the raw histogram, e.g. for aggregating several instances.
+    void getHistogram (std::array<juce::uint32, NUM_BINS>& dest) const
+    {
+        for (int i = 0; i < NUM_BINS; ++i)
+            dest[i] = histogram[i].load (std::memory_order_relaxed);
+    }
+
+    //==============================================================================
+    // Times the scope it lives in and reports it to the meter.
+    struct ScopedMeasurement
+    {
+        ScopedMeasurement (CpuLoadMeter& m, int n)
+            : meter (m), numSamples (n), startTicks (juce::Time::getHighResolutionTicks()) {}
+
+        ~ScopedMeasurement()
+        {
+            meter.addMeasurement (juce::Time::getHighResolutionTicks() - startTicks, numSamples);
+        }
+
+        CpuLoadMeter& meter;
+        int numSamples;
+        juce::int64 startTicks;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedMeasurement)
+    };
+
+private:
+    static float percentileFromCounts (const std::array<juce::uint32, NUM_BINS>& counts,
+                                       juce::uint64 total, double fraction)
+    {
+        if (total == 0)
+            return 0;
+
+        const auto target = (juce::uint64) (fraction * (double) total);
+        juce::uint64 running = 0;
+
+        for (int i = 0; i < NUM_BINS; ++i)
+        {
+            running += counts[i];
+            if (running > target)
+                return (i + 0.5f) * (MAX_LOAD / NUM_BINS); // bin centre
+        }
+
+        return MAX_LOAD;
+    }
+
+    double gTicksPerSample = 0;
+
+    std::array<std::atomic<juce::uint32>, NUM_BINS> histogram {};
+    std::atomic<float> lastLoad { 0 };
+    std::atomic<float> maxLoad { 0 };
+    std::atomic<juce::uint64> numBlocks { 0 };
+    std::atomic<juce::uint64> deadlineMisses { 0 };
+};
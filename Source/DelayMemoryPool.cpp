@@ -0,0 +1,226 @@
+/*
+  ==============================================================================
+
+    DelayMemoryPool.cpp
+
+  ==============================================================================
+*/
+
+#include "DelayMemoryPool.h"
+
+#if JUCE_WINDOWS
+ #include <windows.h>
+#else
+ #include <sys/mman.h>
+ #include <unistd.h>
+#endif
+
+// Transparent huge pages are 2 MB on the platforms that have them
+static const size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+//==============================================================================
+void DelayMemoryPool::Lease::reset()
+{
+    if (pool != nullptr && data != nullptr)
+        pool->release (data);
+
+    pool = nullptr;
+    data = nullptr;
+    numBytes = 0;
+}
+
+//==============================================================================
+DelayMemoryPool::DelayMemoryPool()
+{
+}
+
+DelayMemoryPool::~DelayMemoryPool()
+{
+    // Every Lease must have been returned before the last instance lets go of the pool
+    jassert (usedBlocks.empty());
+
+    for (auto& block : freeBlocks)
+        unmapBlock (block);
+
+    for (auto& block : usedBlocks)
+        unmapBlock (block);
+}
+
+size_t DelayMemoryPool::getPageSize()
+{
+   #if JUCE_WINDOWS
+    SYSTEM_INFO info;
+    GetSystemInfo (&info);
+    return (size_t) info.dwPageSize;
+   #else
+    return (size_t) sysconf (_SC_PAGESIZE);
+   #endif
+}
+
+size_t DelayMemoryPool::roundUpSize (size_t numBytes) const
+{
+    const size_t granularity = useHugePages ? HUGE_PAGE_SIZE : getPageSize();
+    return ((numBytes + granularity - 1) / granularity) * granularity;
+}
+
+//==============================================================================
+DelayMemoryPool::Lease DelayMemoryPool::acquire (size_t numBytes)
+{
+    const juce::ScopedLock sl (lock);
+    const size_t size = roundUpSize (numBytes);
+
+    for (size_t i = 0; i < freeBlocks.size(); ++i)
+    {
+        if (freeBlocks[i].numBytes == size)
+        {
+            auto block = freeBlocks[i];
+            freeBlocks.erase (freeBlocks.begin() + (long) i);
+            usedBlocks.push_back (block);
+            return Lease (this, block.data, numBytes);
+        }
+    }
+
+    auto block = mapBlock (size);
+    if (block.data == nullptr)
+        return {};
+
+    usedBlocks.push_back (block);
+    return Lease (this, block.data, numBytes);
+}
+
+void DelayMemoryPool::release (void* data)
+{
+    const juce::ScopedLock sl (lock);
+
+    for (size_t i = 0; i < usedBlocks.size(); ++i)
+    {
+        if (usedBlocks[i].data == data)
+        {
+            auto block = usedBlocks[i];
+            usedBlocks.erase (usedBlocks.begin() + (long) i);
+
+            // Cleared here, on the releasing thread, so the next acquire hands
+            // out silence without touching megabytes at prepare time.
+            std::memset (block.data, 0, block.numBytes);
+            freeBlocks.push_back (block);
+            return;
+        }
+    }
+
+    jassertfalse; // not one of ours
+}
+
+void DelayMemoryPool::reserve (size_t numBytes, int numBlocks)
+{
+    const juce::ScopedLock sl (lock);
+    const size_t size = roundUpSize (numBytes);
+
+    int numFree = 0;
+    for (auto& block : freeBlocks)
+        if (block.numBytes == size)
+            ++numFree;
+
+    for (int i = numFree; i < numBlocks; ++i)
+    {
+        auto block = mapBlock (size);
+        if (block.data == nullptr)
+            break;
+
+        freeBlocks.push_back (block);
+    }
+}
+
+void DelayMemoryPool::trim()
+{
+    const juce::ScopedLock sl (lock);
+
+    for (auto& block : freeBlocks)
+        unmapBlock (block);
+
+    freeBlocks.clear();
+}
+
+void DelayMemoryPool::setUseHugePages (bool shouldUseHugePages)
+{
+    const juce::ScopedLock sl (lock);
+    useHugePages = shouldUseHugePages;
+}
+
+DelayMemoryPool::Footprint DelayMemoryPool::getFootprint() const
+{
+    const juce::ScopedLock sl (lock);
+    Footprint f;
+
+    for (auto& block : usedBlocks)
+    {
+        f.bytesInUse += block.numBytes;
+        f.bytesMapped += block.numBytes;
+        f.usingHugePages = f.usingHugePages || block.hugePages;
+    }
+
+    for (auto& block : freeBlocks)
+    {
+        f.bytesMapped += block.numBytes;
+        f.usingHugePages = f.usingHugePages || block.hugePages;
+    }
+
+    f.numBlocksInUse = (int) usedBlocks.size();
+    f.numBlocksMapped = (int) (usedBlocks.size() + freeBlocks.size());
+    return f;
+}
+
+//==============================================================================
+DelayMemoryPool::Block DelayMemoryPool::mapBlock (size_t numBytes)
+{
+    Block block { nullptr, numBytes, false };
+
+   #if JUCE_WINDOWS
+    block.data = VirtualAlloc (nullptr, numBytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+   #else
+    #if JUCE_LINUX && defined (MAP_HUGETLB)
+    if (useHugePages)
+    {
+        // Explicit huge pages only work if the admin reserved some; fall back silently
+        void* p = mmap (nullptr, numBytes, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+
+        if (p != MAP_FAILED)
+        {
+            block.data = p;
+            block.hugePages = true;
+        }
+    }
+    #endif
+
+    if (block.data == nullptr)
+    {
+        void* p = mmap (nullptr, numBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        block.data = (p != MAP_FAILED) ? p : nullptr;
+
+       #if JUCE_LINUX && defined (MADV_HUGEPAGE)
+        if (block.data != nullptr && useHugePages)
+            block.hugePages = madvise (block.data, numBytes, MADV_HUGEPAGE) == 0;
+       #endif
+    }
+   #endif
+
+    if (block.data == nullptr)
+    {
+        jassertfalse;
+        return block;
+    }
+
+    // Fresh anonymous memory is already zero; writing it faults every page in
+    // now instead of on the audio thread.
+    std::memset (block.data, 0, numBytes);
+    return block;
+}
+
+void DelayMemoryPool::unmapBlock (const Block& block)
+{
+   #if JUCE_WINDOWS
+    VirtualFree (block.data, 0, MEM_RELEASE);
+   #else
+    munmap (block.data, block.numBytes);
+   #endif
+}
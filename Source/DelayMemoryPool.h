@@ -0,0 +1,113 @@
+/*
+  ==============================================================================
+
+    DelayMemoryPool.h
+    Process-wide pool for delay line storage, shared by all plugin instances.
+
+    Blocks are page aligned (so also cache-line aligned), pre-faulted when they
+    are first mapped and kept on a free list when an instance releases them, so
+    loading a session with many instances doesn't hammer the system allocator
+    and the first processBlock doesn't page-fault.
+
+    Use it through juce::SharedResourcePointer<DelayMemoryPool>: the pool lives
+    as long as at least one instance holds a reference to it.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+class DelayMemoryPool
+{
+public:
+    DelayMemoryPool();
+    ~DelayMemoryPool();
+
+    struct Footprint
+    {
+        size_t bytesMapped = 0;     // everything currently held from the OS
+        size_t bytesInUse = 0;      // handed out to instances
+        int numBlocksMapped = 0;
+        int numBlocksInUse = 0;
+        bool usingHugePages = false;
+    };
+
+    //==============================================================================
+    // RAII handle on a block of pool memory. Returns the block to the pool's
+    // free list when it goes out of scope or is reset.
+    class Lease
+    {
+    public:
+        Lease() = default;
+        Lease (Lease&& other) noexcept            { swap (other); }
+        Lease& operator= (Lease&& other) noexcept { reset(); swap (other); return *this; }
+        ~Lease()                                  { reset(); }
+
+        void reset();
+
+        void* getData() const noexcept   { return data; }
+        size_t getNumBytes() const noexcept { return numBytes; }
+        bool isValid() const noexcept    { return data != nullptr; }
+
+        template <typename T>
+        T* getAs (size_t elementOffset = 0) const noexcept  { return static_cast<T*> (data) + elementOffset; }
+
+    private:
+        friend class DelayMemoryPool;
+        Lease (DelayMemoryPool* p, void* d, size_t n) noexcept : pool (p), data (d), numBytes (n) {}
+
+        void swap (Lease& other) noexcept
+        {
+            std::swap (pool, other.pool);
+            std::swap (data, other.data);
+            std::swap (numBytes, other.numBytes);
+        }
+
+        DelayMemoryPool* pool = nullptr;
+        void* data = nullptr;
+        size_t numBytes = 0;
+
+        JUCE_DECLARE_NON_COPYABLE (Lease)
+    };
+
+    //==============================================================================
+    // Hands out a zeroed block of at least numBytes. Reuses a free block of the
+    // same rounded size if there is one. Not for use on the audio thread.
+    Lease acquire (size_t numBytes);
+
+    // Maps blocks up front, e.g. while a session template is loading.
+    void reserve (size_t numBytes, int numBlocks);
+
+    // Gives every unused block back to the OS.
+    void trim();
+
+    // Only affects blocks mapped after the call.
+    void setUseHugePages (bool shouldUseHugePages);
+
+    Footprint getFootprint() const;
+
+    static size_t getPageSize();
+
+private:
+    struct Block
+    {
+        void* data;
+        size_t numBytes;
+        bool hugePages;
+    };
+
+    void release (void* data);
+    Block mapBlock (size_t numBytes);
+    static void unmapBlock (const Block& block);
+    size_t roundUpSize (size_t numBytes) const;
+
+    juce::CriticalSection lock;
+    std::vector<Block> freeBlocks;
+    std::vector<Block> usedBlocks;
+    bool useHugePages = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DelayMemoryPool)
+};
@@ -0,0 +1,232 @@
+/*
+  ==============================================================================
+
+    LongDelayStorage.cpp
+
+  ==============================================================================
+*/
+
+#include "LongDelayStorage.h"
+
+// How far ahead of each head the spill file pages are touched, in samples
+static const int PREFETCH_SAMPLES = LongDelayStorage::CHUNK_SIZE;
+static const int PAGE_FLOATS = 4096 / (int) sizeof (float);
+
+//==============================================================================
+LongDelayStorage::LongDelayStorage()
+    : juce::Thread ("PingPongDelay long delay storage")
+{
+    for (auto& d : tapDelay)
+        d.store (0);
+}
+
+LongDelayStorage::~LongDelayStorage()
+{
+    release();
+}
+
+//==============================================================================
+void LongDelayStorage::prepare (int linesToUse, int capacitySamples, size_t ramLimitBytes, const juce::File& spillDirectory)
+{
+    release();
+
+    numLines = linesToUse;
+    numChunks = (capacitySamples + CHUNK_SIZE - 1) / CHUNK_SIZE;
+
+    // The write head must always have a few chunks of room ahead and behind
+    numChunks = juce::jmax (numChunks, LOOKAHEAD_CHUNKS + MARGIN_CHUNKS + 2);
+
+    const size_t totalChunks = (size_t) numLines * (size_t) numChunks;
+    const size_t totalBytes = totalChunks * CHUNK_SIZE * sizeof (float);
+
+    chunks.reset (new std::atomic<float*>[totalChunks]);
+    for (size_t i = 0; i < totalChunks; ++i)
+        chunks[i].store (nullptr);
+
+    writeHead.store (0);
+    epoch.store (0);
+    numChunksInRam.store (0);
+
+    if (totalBytes > ramLimitBytes)
+    {
+        // Spill to disk. The file is created sparse, so it costs nothing until written.
+        spillFile = spillDirectory.getNonexistentChildFile ("PingPongDelay", ".spill", false);
+
+        bool sized = false;
+        {
+            juce::FileOutputStream out (spillFile);
+
+            if (out.openedOk())
+                sized = out.setPosition ((juce::int64) totalBytes - 1) && out.writeByte (0);
+        }
+
+        if (sized)
+            mappedFile = std::make_unique<juce::MemoryMappedFile> (spillFile, juce::MemoryMappedFile::readWrite);
+
+        if (mappedFile != nullptr && mappedFile->getData() != nullptr && mappedFile->getSize() >= totalBytes)
+        {
+            auto* base = static_cast<float*> (mappedFile->getData());
+
+            for (size_t i = 0; i < totalChunks; ++i)
+                chunks[i].store (base + i * CHUNK_SIZE);
+        }
+        else
+        {
+            // Couldn't map a file (read-only volume, full disk...): stay in RAM
+            jassertfalse;
+            mappedFile.reset();
+            spillFile.deleteFile();
+        }
+    }
+
+    // Have the start of every line ready before the first block
+    service();
+
+    startThread();
+}
+
+void LongDelayStorage::release()
+{
+    stopThread (1000);
+
+    if (chunks != nullptr && mappedFile == nullptr)
+    {
+        for (size_t i = 0; i < (size_t) numLines * (size_t) numChunks; ++i)
+            delete[] chunks[i].exchange (nullptr);
+    }
+
+    freeRetiredChunks (true);
+
+    chunks.reset();
+    mappedFile.reset();
+
+    if (spillFile != juce::File())
+    {
+        spillFile.deleteFile();
+        spillFile = juce::File();
+    }
+
+    numLines = 0;
+    numChunks = 0;
+    numChunksInRam.store (0);
+}
+
+//==============================================================================
+void LongDelayStorage::setPlayheads (int writePos, const int (&tapDelays)[MAX_TAPS]) noexcept
+{
+    writeHead.store (writePos, std::memory_order_relaxed);
+
+    for (int i = 0; i < MAX_TAPS; ++i)
+        tapDelay[i].store (tapDelays[i], std::memory_order_relaxed);
+
+    // Publishes that the block is over: chunks retired before this point
+    // can't be in use by the audio thread any more after the next block.
+    epoch.fetch_add (1, std::memory_order_release);
+}
+
+void LongDelayStorage::run()
+{
+    while (! threadShouldExit())
+    {
+        wait (5);
+        service();
+    }
+}
+
+void LongDelayStorage::service()
+{
+    const int capacity = getCapacity();
+    const int w = writeHead.load (std::memory_order_relaxed);
+
+    int reach = 0;
+    int delays[MAX_TAPS];
+    for (int i = 0; i < MAX_TAPS; ++i)
+    {
+        delays[i] = tapDelay[i].load (std::memory_order_relaxed);
+        reach = juce::jmax (reach, delays[i]);
+    }
+
+    if (mappedFile != nullptr)
+    {
+        // Spill file: fault in what the write head and the taps are about to touch
+        touchRange (w, PREFETCH_SAMPLES);
+
+        for (int i = 0; i < MAX_TAPS; ++i)
+            touchRange (((w - delays[i] - 2) % capacity + capacity) % capacity, PREFETCH_SAMPLES);
+
+        return;
+    }
+
+    const juce::uint32 currentEpoch = epoch.load (std::memory_order_acquire);
+    const int writeChunk = w >> CHUNK_BITS;
+    const int reachChunks = reach / CHUNK_SIZE + 1 + MARGIN_CHUNKS;
+
+    for (int line = 0; line < numLines; ++line)
+    {
+        auto* lineChunks = chunks.get() + (size_t) line * (size_t) numChunks;
+
+        for (int c = 0; c < numChunks; ++c)
+        {
+            // distance of chunk c behind the write head, 0 .. numChunks-1
+            const int behind = ((writeChunk - c) % numChunks + numChunks) % numChunks;
+            const bool ahead = behind >= numChunks - LOOKAHEAD_CHUNKS;
+            const bool needed = behind <= reachChunks || ahead;
+
+            if (needed && lineChunks[c].load (std::memory_order_relaxed) == nullptr)
+            {
+                // Fresh chunks are silent, so a tap reaching into one reads zeros
+                auto* data = new float[CHUNK_SIZE]();
+                lineChunks[c].store (data, std::memory_order_release);
+                numChunksInRam.fetch_add (1);
+            }
+            else if (! needed)
+            {
+                if (auto* data = lineChunks[c].exchange (nullptr, std::memory_order_acq_rel))
+                {
+                    retired.push_back ({ data, currentEpoch });
+                    numChunksInRam.fetch_sub (1);
+                }
+            }
+        }
+    }
+
+    freeRetiredChunks (false);
+}
+
+void LongDelayStorage::freeRetiredChunks (bool force)
+{
+    const juce::uint32 currentEpoch = epoch.load (std::memory_order_acquire);
+
+    for (auto it = retired.begin(); it != retired.end();)
+    {
+        // The block that might have loaded the pointer has finished once the
+        // epoch moved on by two
+        if (force || currentEpoch - it->epoch >= 2)
+        {
+            delete[] it->data;
+            it = retired.erase (it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+void LongDelayStorage::touchRange (int startPos, int numSamples)
+{
+    const int capacity = getCapacity();
+    float sum = 0;
+
+    for (int line = 0; line < numLines; ++line)
+    {
+        for (int i = 0; i < numSamples; i += PAGE_FLOATS)
+        {
+            const int pos = (startPos + i) % capacity;
+            auto* chunk = chunks[(size_t) (line * numChunks + (pos >> CHUNK_BITS))].load (std::memory_order_relaxed);
+            sum += static_cast<volatile float*> (chunk)[pos & CHUNK_MASK];
+        }
+    }
+
+    juce::ignoreUnused (sum);
+}
@@ -0,0 +1,102 @@
+/*
+  ==============================================================================
+
+    LongDelayStorage.h
+    Delay lines of minutes, for the long delay / looper mode.
+
+    The lines are split into fixed size chunks. In RAM mode the chunks are
+    allocated lazily by a background thread just ahead of the write head, and
+    chunks the taps can no longer reach are given back, so a 5 minute line that
+    is only used at 10 seconds costs about 10 seconds of memory.
+
+    Past a configurable size the lines live in a memory-mapped spill file
+    instead. The OS pages it in and out; the background thread touches the
+    pages just ahead of the write head and of every read tap so the audio
+    thread doesn't wait on the disk.
+
+    The audio thread never allocates, locks or does I/O here: a write into a
+    chunk that isn't ready yet is dropped, a read from one returns silence.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+class LongDelayStorage  : private juce::Thread
+{
+public:
+    static constexpr int CHUNK_BITS = 15;               // 32768 samples per chunk
+    static constexpr int CHUNK_SIZE = 1 << CHUNK_BITS;
+    static constexpr int CHUNK_MASK = CHUNK_SIZE - 1;
+    static constexpr int MAX_TAPS = 2;
+
+    LongDelayStorage();
+    ~LongDelayStorage() override;
+
+    //==============================================================================
+    // Message thread. The capacity is rounded up to whole chunks. If the lines
+    // need more than ramLimitBytes in total they are backed by a temporary
+    // memory-mapped file in spillDirectory.
+    void prepare (int numLines, int capacitySamples, size_t ramLimitBytes, const juce::File& spillDirectory);
+    void release();
+
+    bool isPrepared() const noexcept    { return numChunks > 0; }
+    bool isFileBacked() const noexcept  { return mappedFile != nullptr; }
+    int getCapacity() const noexcept    { return numChunks * CHUNK_SIZE; }
+
+    // Bytes of RAM currently held by chunks (0 when file backed)
+    size_t getBytesInRam() const noexcept { return (size_t) numChunksInRam.load() * CHUNK_SIZE * sizeof (float); }
+
+    //==============================================================================
+    // Audio thread
+    inline void write (int line, int pos, float value) noexcept
+    {
+        if (auto* chunk = chunks[(size_t) (line * numChunks + (pos >> CHUNK_BITS))].load (std::memory_order_acquire))
+            chunk[pos & CHUNK_MASK] = value;
+    }
+
+    inline float read (int line, int pos) const noexcept
+    {
+        if (auto* chunk = chunks[(size_t) (line * numChunks + (pos >> CHUNK_BITS))].load (std::memory_order_acquire))
+            return chunk[pos & CHUNK_MASK];
+
+        return 0;
+    }
+
+    // Call once at the end of every block with the write position and the
+    // current tap delays, so the background thread knows what to prepare.
+    void setPlayheads (int writePos, const int (&tapDelays)[MAX_TAPS]) noexcept;
+
+private:
+    void run() override;
+    void service();
+    void freeRetiredChunks (bool force);
+    void touchRange (int startPos, int numSamples);
+
+    static constexpr int LOOKAHEAD_CHUNKS = 2;  // chunks kept ready ahead of the write head
+    static constexpr int MARGIN_CHUNKS = 2;     // kept behind the furthest tap
+
+    int numLines = 0;
+    int numChunks = 0;
+    std::unique_ptr<std::atomic<float*>[]> chunks;   // numLines x numChunks
+
+    struct RetiredChunk
+    {
+        float* data;
+        juce::uint32 epoch;
+    };
+    std::vector<RetiredChunk> retired;
+
+    std::unique_ptr<juce::MemoryMappedFile> mappedFile;
+    juce::File spillFile;
+
+    std::atomic<int> writeHead { 0 };
+    std::atomic<int> tapDelay[MAX_TAPS];
+    std::atomic<juce::uint32> epoch { 0 };   // blocks completed
+    std::atomic<int> numChunksInRam { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LongDelayStorage)
+};
@@ -1,146 +1,459 @@
-/*
-  ==============================================================================
-
-    This file contains the basic framework code for a JUCE plugin editor.
-
-  ==============================================================================
-*/
-
-#include "PluginProcessor.h"
-#include "PluginEditor.h"
-
-//==============================================================================
-PingPongDelayAudioProcessorEditor::PingPongDelayAudioProcessorEditor (PingPongDelayAudioProcessor& p)
-    : AudioProcessorEditor (&p), audioProcessor (p)
-{
-    // Make sure that before the constructor has finished, you've set the
-    // editor's size to whatever you need it to be.
-    setSize (400, 300);
-    
-    addAndMakeVisible(del_L_Slider);
-    del_L_Slider.setTextValueSuffix(" [ms]");
-    del_L_Slider.addListener(this);
-    del_L_Slider.setRange(0.0,2000.0);
-    del_L_Slider.setValue(0.0);
-    addAndMakeVisible(del_L_Label);
-    del_L_Label.setText("Delay L", juce::dontSendNotification);
-    del_L_Label.attachToComponent(&del_L_Slider, true);
-    
-    del_L_SliderAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.apvts,"DEL_L",del_L_Slider);
-    
-    addAndMakeVisible(del_R_Slider);
-    del_R_Slider.setTextValueSuffix(" [ms]");
-    del_R_Slider.addListener(this);
-    del_R_Slider.setRange(0.0,2000.0);
-    del_R_Slider.setValue(0.0);
-    addAndMakeVisible(del_R_Label);
-    del_R_Label.setText("Delay R", juce::dontSendNotification);
-    del_R_Label.attachToComponent(&del_R_Slider, true);
-    
-    del_R_SliderAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.apvts,"DEL_R",del_R_Slider);
-    
-    addAndMakeVisible(feedback_L_Slider);
-    feedback_L_Slider.setTextValueSuffix(" [-]");
-    feedback_L_Slider.addListener(this);
-    feedback_L_Slider.setRange(0.0,1.0);
-    feedback_L_Slider.setValue(0.0);
-    addAndMakeVisible(feedback_L_Label);
-    feedback_L_Label.setText("Feedback L", juce::dontSendNotification);
-    feedback_L_Label.attachToComponent(&feedback_L_Slider, true);
-    
-    feedback_L_SliderAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.apvts,"FEEDBACK_L",feedback_L_Slider);
-    
-    addAndMakeVisible(feedback_R_Slider);
-    feedback_R_Slider.setTextValueSuffix(" [-]");
-    feedback_R_Slider.addListener(this);
-    feedback_R_Slider.setRange(0.0,1.0);
-    feedback_R_Slider.setValue(0.0);
-    addAndMakeVisible(feedback_R_Label);
-    feedback_R_Label.setText("Feedback R", juce::dontSendNotification);
-    feedback_R_Label.attachToComponent(&feedback_R_Slider, true);
-    
-    feedback_R_SliderAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.apvts,"FEEDBACK_R",feedback_R_Slider);
-    
-    addAndMakeVisible(drywet_Slider);
-    drywet_Slider.setTextValueSuffix(" [-]");
-    drywet_Slider.addListener(this);
-    drywet_Slider.setRange(0.0,1.0);
-    drywet_Slider.setValue(0.0);
-    addAndMakeVisible(drywet_Label);
-    drywet_Label.setText("Dry Wet", juce::dontSendNotification);
-    drywet_Label.attachToComponent(&drywet_Slider, true);
-    
-    drywet_SliderAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.apvts,"DRY_WET",drywet_Slider);
-    
-    addAndMakeVisible(vol_Slider);
-    vol_Slider.setTextValueSuffix(" [-]");
-    vol_Slider.addListener(this);
-    vol_Slider.setRange(-20.0,20.0);
-    vol_Slider.setValue(0.0);
-    addAndMakeVisible(vol_Label);
-    vol_Label.setText("Volume", juce::dontSendNotification);
-    vol_Label.attachToComponent(&vol_Slider, true);
-    
-    vol_SliderAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.apvts,"VOLUME",vol_Slider);
-}
-
-PingPongDelayAudioProcessorEditor::~PingPongDelayAudioProcessorEditor()
-{
-}
-
-//==============================================================================
-void PingPongDelayAudioProcessorEditor::paint (juce::Graphics& g)
-{
-    // (Our component is opaque, so we must completely fill the background with a solid colour)
-    g.fillAll (getLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId));
-
-//    g.setColour (juce::Colours::white);
-//    g.setFont (15.0f);
-//    g.drawFittedText ("Hello World!", getLocalBounds(), juce::Justification::centred, 1);
-}
-
-void PingPongDelayAudioProcessorEditor::resized()
-{
-    auto sliderLeft = 120;
-
-    del_L_Slider.setBounds(sliderLeft, 20, getWidth() - sliderLeft - 10, 20);
-    del_R_Slider.setBounds(sliderLeft, 60, getWidth() - sliderLeft - 10, 20);
-    feedback_L_Slider.setBounds(sliderLeft, 60+40, getWidth() - sliderLeft - 10, 20);
-    feedback_R_Slider.setBounds(sliderLeft, 60+40+40, getWidth() - sliderLeft - 10, 20);
-    drywet_Slider.setBounds(sliderLeft, 60+40+40+40, getWidth() - sliderLeft - 10, 20);
-    vol_Slider.setBounds(sliderLeft, 60+40+40+40+40, getWidth() - sliderLeft - 10, 20);
-    
-
-}
-
-
-void PingPongDelayAudioProcessorEditor::sliderValueChanged(Slider* slider)
-{
-
-    if (slider == &del_L_Slider)
-    {
-        audioProcessor.set_del_L_param(del_L_Slider.getValue());
-    }
-    else if (slider == &del_R_Slider)
-    {
-        audioProcessor.set_del_R_param(del_R_Slider.getValue());
-    }
-    else if (slider == &feedback_L_Slider)
-    {
-        audioProcessor.set_feedback_L_param(feedback_L_Slider.getValue());
-    }
-    else if (slider == &feedback_R_Slider)
-    {
-        audioProcessor.set_feedback_R_param(feedback_R_Slider.getValue());
-    }
-    else if (slider == &drywet_Slider)
-    {
-        audioProcessor.set_drywet_param(drywet_Slider.getValue());
-    }
-    else if (slider == &vol_Slider)
-    {
-        audioProcessor.set_gVolume_param(vol_Slider.getValue());
-    }
-}
-
-
+/*
+  ==============================================================================
+
+    This file contains the basic framework code for a JUCE plugin editor.
+
+  ==============================================================================
+*/
+
+#include "PluginProcessor.h"
+#include "PluginEditor.h"
+
+//==============================================================================
+PingPongDelayAudioProcessorEditor::PingPongDelayAudioProcessorEditor (PingPongDelayAudioProcessor& p)
+    : AudioProcessorEditor (&p), audioProcessor (p)
+{
+    // Make sure that before the constructor has finished, you've set the
+    // editor's size to whatever you need it to be.
+    setSize (400, 20 + 40*(int) getRowComponents().size() + 30);
+    
+    addAndMakeVisible(del_L_Slider);
+    del_L_Slider.setTextValueSuffix(" [ms]");
+    del_L_Slider.addListener(this);
+    del_L_Slider.setRange(0.0,2000.0);
+    del_L_Slider.setValue(0.0);
+    addAndMakeVisible(del_L_Label);
+    del_L_Label.setText("Delay L", juce::dontSendNotification);
+    del_L_Label.attachToComponent(&del_L_Slider, true);
+    
+    del_L_SliderAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.apvts,"DEL_L",del_L_Slider);
+    
+    addAndMakeVisible(del_R_Slider);
+    del_R_Slider.setTextValueSuffix(" [ms]");
+    del_R_Slider.addListener(this);
+    del_R_Slider.setRange(0.0,2000.0);
+    del_R_Slider.setValue(0.0);
+    addAndMakeVisible(del_R_Label);
+    del_R_Label.setText("Delay R", juce::dontSendNotification);
+    del_R_Label.attachToComponent(&del_R_Slider, true);
+    
+    del_R_SliderAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.apvts,"DEL_R",del_R_Slider);
+    
+    addAndMakeVisible(feedback_L_Slider);
+    feedback_L_Slider.setTextValueSuffix(" [-]");
+    feedback_L_Slider.addListener(this);
+    feedback_L_Slider.setRange(0.0,1.0);
+    feedback_L_Slider.setValue(0.0);
+    addAndMakeVisible(feedback_L_Label);
+    feedback_L_Label.setText("Feedback L", juce::dontSendNotification);
+    feedback_L_Label.attachToComponent(&feedback_L_Slider, true);
+    
+    feedback_L_SliderAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.apvts,"FEEDBACK_L",feedback_L_Slider);
+    
+    addAndMakeVisible(feedback_R_Slider);
+    feedback_R_Slider.setTextValueSuffix(" [-]");
+    feedback_R_Slider.addListener(this);
+    feedback_R_Slider.setRange(0.0,1.0);
+    feedback_R_Slider.setValue(0.0);
+    addAndMakeVisible(feedback_R_Label);
+    feedback_R_Label.setText("Feedback R", juce::dontSendNotification);
+    feedback_R_Label.attachToComponent(&feedback_R_Slider, true);
+    
+    feedback_R_SliderAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.apvts,"FEEDBACK_R",feedback_R_Slider);
+    
+    addAndMakeVisible(drywet_Slider);
+    drywet_Slider.setTextValueSuffix(" [-]");
+    drywet_Slider.addListener(this);
+    drywet_Slider.setRange(0.0,1.0);
+    drywet_Slider.setValue(0.0);
+    addAndMakeVisible(drywet_Label);
+    drywet_Label.setText("Dry Wet", juce::dontSendNotification);
+    drywet_Label.attachToComponent(&drywet_Slider, true);
+    
+    drywet_SliderAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.apvts,"DRY_WET",drywet_Slider);
+    
+    addAndMakeVisible(vol_Slider);
+    vol_Slider.setTextValueSuffix(" [-]");
+    vol_Slider.addListener(this);
+    vol_Slider.setRange(-20.0,20.0);
+    vol_Slider.setValue(0.0);
+    addAndMakeVisible(vol_Label);
+    vol_Label.setText("Volume", juce::dontSendNotification);
+    vol_Label.attachToComponent(&vol_Slider, true);
+    
+    vol_SliderAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.apvts,"VOLUME",vol_Slider);
+    
+    addAndMakeVisible(timeMode_Box);
+    timeMode_Box.addItemList(audioProcessor.apvts.getParameter("TIME_MODE")->getAllValueStrings(), 1);
+    addAndMakeVisible(timeMode_Label);
+    timeMode_Label.setText("Time Mode", juce::dontSendNotification);
+    timeMode_Label.attachToComponent(&timeMode_Box, true);
+    
+    timeMode_BoxAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(audioProcessor.apvts,"TIME_MODE",timeMode_Box);
+    
+    addAndMakeVisible(fadeTime_Slider);
+    fadeTime_Slider.setTextValueSuffix(" [ms]");
+    addAndMakeVisible(fadeTime_Label);
+    fadeTime_Label.setText("Fade Time", juce::dontSendNotification);
+    fadeTime_Label.attachToComponent(&fadeTime_Slider, true);
+    
+    fadeTime_SliderAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.apvts,"FADE_TIME",fadeTime_Slider);
+    
+    addAndMakeVisible(tapeRate_Slider);
+    tapeRate_Slider.setTextValueSuffix(" [s/s]");
+    addAndMakeVisible(tapeRate_Label);
+    tapeRate_Label.setText("Tape Rate", juce::dontSendNotification);
+    tapeRate_Label.attachToComponent(&tapeRate_Slider, true);
+    
+    tapeRate_SliderAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.apvts,"TAPE_RATE",tapeRate_Slider);
+    
+    // Long delay / looper mode: takes over from Delay L/R when on
+    addAndMakeVisible(longMode_Button);
+    longMode_Button.setButtonText("Long delay mode");
+    longMode_ButtonAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(audioProcessor.apvts,"LONG_MODE",longMode_Button);
+    
+    addAndMakeVisible(longDel_L_Slider);
+    longDel_L_Slider.setTextValueSuffix(" [s]");
+    addAndMakeVisible(longDel_L_Label);
+    longDel_L_Label.setText("Long Delay L", juce::dontSendNotification);
+    longDel_L_Label.attachToComponent(&longDel_L_Slider, true);
+    
+    longDel_L_SliderAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.apvts,"LONG_DEL_L",longDel_L_Slider);
+    
+    addAndMakeVisible(longDel_R_Slider);
+    longDel_R_Slider.setTextValueSuffix(" [s]");
+    addAndMakeVisible(longDel_R_Label);
+    longDel_R_Label.setText("Long Delay R", juce::dontSendNotification);
+    longDel_R_Label.attachToComponent(&longDel_R_Slider, true);
+    
+    longDel_R_SliderAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.apvts,"LONG_DEL_R",longDel_R_Slider);
+    
+    addAndMakeVisible(freeze_Button);
+    freeze_Button.setButtonText("Freeze");
+    freeze_ButtonAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(audioProcessor.apvts,"FREEZE",freeze_Button);
+    
+    addAndMakeVisible(softLimit_Button);
+    softLimit_Button.setButtonText("Soft Limiter");
+    softLimit_ButtonAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(audioProcessor.apvts,"SOFT_LIMIT",softLimit_Button);
+    
+    addAndMakeVisible(diffusion_Slider);
+    diffusion_Slider.setTextValueSuffix(" [-]");
+    addAndMakeVisible(diffusion_Label);
+    diffusion_Label.setText("Diffusion", juce::dontSendNotification);
+    diffusion_Label.attachToComponent(&diffusion_Slider, true);
+    
+    diffusion_SliderAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.apvts,"DIFFUSION",diffusion_Slider);
+    
+    addAndMakeVisible(shimmer_Slider);
+    shimmer_Slider.setTextValueSuffix(" [-]");
+    addAndMakeVisible(shimmer_Label);
+    shimmer_Label.setText("Shimmer", juce::dontSendNotification);
+    shimmer_Label.attachToComponent(&shimmer_Slider, true);
+    
+    shimmer_SliderAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.apvts,"SHIMMER",shimmer_Slider);
+    
+    addAndMakeVisible(shimmerPitch_Box);
+    shimmerPitch_Box.addItemList(audioProcessor.apvts.getParameter("SHIMMER_PITCH")->getAllValueStrings(), 1);
+    addAndMakeVisible(shimmerPitch_Label);
+    shimmerPitch_Label.setText("Shimmer Pitch", juce::dontSendNotification);
+    shimmerPitch_Label.attachToComponent(&shimmerPitch_Box, true);
+    
+    shimmerPitch_BoxAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(audioProcessor.apvts,"SHIMMER_PITCH",shimmerPitch_Box);
+    
+    addAndMakeVisible(reverse_Button);
+    reverse_Button.setButtonText("Reverse");
+    reverse_ButtonAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(audioProcessor.apvts,"REVERSE",reverse_Button);
+    
+    addAndMakeVisible(drive_Slider);
+    drive_Slider.setTextValueSuffix(" [-]");
+    addAndMakeVisible(drive_Label);
+    drive_Label.setText("Drive", juce::dontSendNotification);
+    drive_Label.attachToComponent(&drive_Slider, true);
+    
+    drive_SliderAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.apvts,"DRIVE",drive_Slider);
+    
+    addAndMakeVisible(bands_Box);
+    bands_Box.addItemList(audioProcessor.apvts.getParameter("BANDS")->getAllValueStrings(), 1);
+    addAndMakeVisible(bands_Label);
+    bands_Label.setText("Multiband", juce::dontSendNotification);
+    bands_Label.attachToComponent(&bands_Box, true);
+    
+    bands_BoxAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(audioProcessor.apvts,"BANDS",bands_Box);
+    
+    addAndMakeVisible(crossoverLow_Slider);
+    crossoverLow_Slider.setTextValueSuffix(" [Hz]");
+    addAndMakeVisible(crossoverLow_Label);
+    crossoverLow_Label.setText("Crossover Low", juce::dontSendNotification);
+    crossoverLow_Label.attachToComponent(&crossoverLow_Slider, true);
+    
+    crossoverLow_SliderAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.apvts,"CROSSOVER_LOW",crossoverLow_Slider);
+    
+    addAndMakeVisible(crossoverHigh_Slider);
+    crossoverHigh_Slider.setTextValueSuffix(" [Hz]");
+    addAndMakeVisible(crossoverHigh_Label);
+    crossoverHigh_Label.setText("Crossover High", juce::dontSendNotification);
+    crossoverHigh_Label.attachToComponent(&crossoverHigh_Slider, true);
+    
+    crossoverHigh_SliderAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.apvts,"CROSSOVER_HIGH",crossoverHigh_Slider);
+    
+    const char* bandNames[3] = { "Low", "Mid", "High" };
+    const char* bandIds[3] = { "LOW", "MID", "HIGH" };
+    
+    for (int band = 0; band < 3; ++band)
+    {
+        addAndMakeVisible(bandDel_Sliders[band]);
+        bandDel_Sliders[band].setTextValueSuffix(" [ms]");
+        addAndMakeVisible(bandDel_Labels[band]);
+        bandDel_Labels[band].setText(String("Delay ") + bandNames[band], juce::dontSendNotification);
+        bandDel_Labels[band].attachToComponent(&bandDel_Sliders[band], true);
+        
+        bandDel_SliderAttachments[band] = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.apvts,String("BAND_DEL_") + bandIds[band],bandDel_Sliders[band]);
+        
+        addAndMakeVisible(bandFeedback_Sliders[band]);
+        bandFeedback_Sliders[band].setTextValueSuffix(" [-]");
+        addAndMakeVisible(bandFeedback_Labels[band]);
+        bandFeedback_Labels[band].setText(String("Feedback ") + bandNames[band], juce::dontSendNotification);
+        bandFeedback_Labels[band].attachToComponent(&bandFeedback_Sliders[band], true);
+        
+        bandFeedback_SliderAttachments[band] = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.apvts,String("BAND_FEEDBACK_") + bandIds[band],bandFeedback_Sliders[band]);
+    }
+    
+    addAndMakeVisible(duckAmount_Slider);
+    duckAmount_Slider.setTextValueSuffix(" [-]");
+    addAndMakeVisible(duckAmount_Label);
+    duckAmount_Label.setText("Duck Amount", juce::dontSendNotification);
+    duckAmount_Label.attachToComponent(&duckAmount_Slider, true);
+    
+    duckAmount_SliderAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.apvts,"DUCK_AMOUNT",duckAmount_Slider);
+    
+    addAndMakeVisible(duckAttack_Slider);
+    duckAttack_Slider.setTextValueSuffix(" [ms]");
+    addAndMakeVisible(duckAttack_Label);
+    duckAttack_Label.setText("Duck Attack", juce::dontSendNotification);
+    duckAttack_Label.attachToComponent(&duckAttack_Slider, true);
+    
+    duckAttack_SliderAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.apvts,"DUCK_ATTACK",duckAttack_Slider);
+    
+    addAndMakeVisible(duckRelease_Slider);
+    duckRelease_Slider.setTextValueSuffix(" [ms]");
+    addAndMakeVisible(duckRelease_Label);
+    duckRelease_Label.setText("Duck Release", juce::dontSendNotification);
+    duckRelease_Label.attachToComponent(&duckRelease_Slider, true);
+    
+    duckRelease_SliderAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.apvts,"DUCK_RELEASE",duckRelease_Slider);
+    
+    addAndMakeVisible(duckThreshold_Slider);
+    duckThreshold_Slider.setTextValueSuffix(" [dB]");
+    addAndMakeVisible(duckThreshold_Label);
+    duckThreshold_Label.setText("Duck Threshold", juce::dontSendNotification);
+    duckThreshold_Label.attachToComponent(&duckThreshold_Slider, true);
+    
+    duckThreshold_SliderAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.apvts,"DUCK_THRESHOLD",duckThreshold_Slider);
+    
+    addAndMakeVisible(fdnLines_Box);
+    fdnLines_Box.addItemList(audioProcessor.apvts.getParameter("FDN_LINES")->getAllValueStrings(), 1);
+    addAndMakeVisible(fdnLines_Label);
+    fdnLines_Label.setText("Network", juce::dontSendNotification);
+    fdnLines_Label.attachToComponent(&fdnLines_Box, true);
+    
+    fdnLines_BoxAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(audioProcessor.apvts,"FDN_LINES",fdnLines_Box);
+    
+    addAndMakeVisible(fdnMatrix_Box);
+    fdnMatrix_Box.addItemList(audioProcessor.apvts.getParameter("FDN_MATRIX")->getAllValueStrings(), 1);
+    addAndMakeVisible(fdnMatrix_Label);
+    fdnMatrix_Label.setText("FDN Matrix", juce::dontSendNotification);
+    fdnMatrix_Label.attachToComponent(&fdnMatrix_Box, true);
+    
+    fdnMatrix_BoxAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(audioProcessor.apvts,"FDN_MATRIX",fdnMatrix_Box);
+    
+    // Not parameters either: files, loaded and prepared on the message thread
+    addAndMakeVisible(irL_Button);
+    irL_Button.onClick = [this] { showColorationIRMenu(0); };
+    addAndMakeVisible(irL_Label);
+    irL_Label.setText("IR L", juce::dontSendNotification);
+    irL_Label.attachToComponent(&irL_Button, true);
+    
+    addAndMakeVisible(irR_Button);
+    irR_Button.onClick = [this] { showColorationIRMenu(1); };
+    addAndMakeVisible(irR_Label);
+    irR_Label.setText("IR R", juce::dontSendNotification);
+    irR_Label.attachToComponent(&irR_Button, true);
+    
+    updateColorationIRButtons();
+    
+    // Not an automatable parameter: changing it reallocates and clears the delay memory
+    addAndMakeVisible(storage_Box);
+    storage_Box.addItem("Float 32", 1 + (int) DelaySampleFormat::float32);
+    storage_Box.addItem("Float 16", 1 + (int) DelaySampleFormat::float16);
+    storage_Box.addItem("Int 16", 1 + (int) DelaySampleFormat::int16);
+    storage_Box.setSelectedId(1 + (int) audioProcessor.getDelayStorageFormat(), juce::dontSendNotification);
+    storage_Box.onChange = [this]
+    {
+        audioProcessor.setDelayStorageFormat((DelaySampleFormat) (storage_Box.getSelectedId() - 1));
+    };
+    addAndMakeVisible(storage_Label);
+    storage_Label.setText("Storage", juce::dontSendNotification);
+    storage_Label.attachToComponent(&storage_Box, true);
+    
+    // Not automatable either, for the same reason
+    addAndMakeVisible(economy_Box);
+    economy_Box.addItem("Full rate", 1);
+    economy_Box.addItem("1/2 rate", 2);
+    economy_Box.addItem("1/4 rate", 4);
+    economy_Box.setSelectedId(audioProcessor.getEconomyFactor(), juce::dontSendNotification);
+    economy_Box.onChange = [this]
+    {
+        audioProcessor.setEconomyFactor(economy_Box.getSelectedId());
+    };
+    addAndMakeVisible(economy_Label);
+    economy_Label.setText("Economy", juce::dontSendNotification);
+    economy_Label.attachToComponent(&economy_Box, true);
+    
+    addAndMakeVisible(cpuLoad_Label);
+    cpuLoad_Label.setFont(juce::Font(12.0f));
+    cpuLoad_Label.setJustificationType(juce::Justification::centredLeft);
+    
+    startTimerHz(10);
+}
+
+PingPongDelayAudioProcessorEditor::~PingPongDelayAudioProcessorEditor()
+{
+    stopTimer();
+}
+
+//==============================================================================
+void PingPongDelayAudioProcessorEditor::paint (juce::Graphics& g)
+{
+    // (Our component is opaque, so we must completely fill the background with a solid colour)
+    g.fillAll (getLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId));
+
+//    g.setColour (juce::Colours::white);
+//    g.setFont (15.0f);
+//    g.drawFittedText ("Hello World!", getLocalBounds(), juce::Justification::centred, 1);
+}
+
+void PingPongDelayAudioProcessorEditor::resized()
+{
+    auto sliderLeft = 120;
+    auto y = 20;
+
+    // One control per row, labels are attached to their left
+    for (auto* control : getRowComponents())
+    {
+        control->setBounds(sliderLeft, y, getWidth() - sliderLeft - 10, 20);
+        y += 40;
+    }
+    
+    cpuLoad_Label.setBounds(10, getHeight() - 30, getWidth() - 20, 20);
+}
+
+std::vector<juce::Component*> PingPongDelayAudioProcessorEditor::getRowComponents()
+{
+    return { &del_L_Slider, &del_R_Slider, &feedback_L_Slider, &feedback_R_Slider, &drywet_Slider, &vol_Slider,
+             &timeMode_Box, &fadeTime_Slider, &tapeRate_Slider,
+             &longMode_Button, &longDel_L_Slider, &longDel_R_Slider,
+             &freeze_Button, &softLimit_Button, &diffusion_Slider,
+             &shimmer_Slider, &shimmerPitch_Box, &reverse_Button, &drive_Slider,
+             &bands_Box, &crossoverLow_Slider, &crossoverHigh_Slider,
+             &bandDel_Sliders[0], &bandFeedback_Sliders[0], &bandDel_Sliders[1], &bandFeedback_Sliders[1],
+             &bandDel_Sliders[2], &bandFeedback_Sliders[2],
+             &duckAmount_Slider, &duckAttack_Slider, &duckRelease_Slider, &duckThreshold_Slider,
+             &fdnLines_Box, &fdnMatrix_Box,
+             &irL_Button, &irR_Button,
+             &storage_Box, &economy_Box };
+}
+
+
+void PingPongDelayAudioProcessorEditor::sliderValueChanged(Slider* slider)
+{
+
+    if (slider == &del_L_Slider)
+    {
+        audioProcessor.set_del_L_param(del_L_Slider.getValue());
+    }
+    else if (slider == &del_R_Slider)
+    {
+        audioProcessor.set_del_R_param(del_R_Slider.getValue());
+    }
+    else if (slider == &feedback_L_Slider)
+    {
+        audioProcessor.set_feedback_L_param(feedback_L_Slider.getValue());
+    }
+    else if (slider == &feedback_R_Slider)
+    {
+        audioProcessor.set_feedback_R_param(feedback_R_Slider.getValue());
+    }
+    else if (slider == &drywet_Slider)
+    {
+        audioProcessor.set_drywet_param(drywet_Slider.getValue());
+    }
+    else if (slider == &vol_Slider)
+    {
+        audioProcessor.set_gVolume_param(vol_Slider.getValue());
+    }
+}
+
+void PingPongDelayAudioProcessorEditor::showColorationIRMenu (int side)
+{
+    PopupMenu menu;
+    menu.addItem(1, "Load IR...");
+    menu.addItem(2, "Clear", audioProcessor.getColorationIRName(side).isNotEmpty());
+    
+    menu.showMenuAsync(PopupMenu::Options().withTargetComponent(side == 0 ? &irL_Button : &irR_Button),
+                       [this, side] (int result)
+    {
+        if (result == 2)
+        {
+            audioProcessor.clearColorationIR(side);
+            updateColorationIRButtons();
+        }
+        else if (result == 1)
+        {
+            irChooser = std::make_unique<FileChooser>("Impulse response", File(), "*.wav;*.aif;*.aiff;*.flac");
+            irChooser->launchAsync(FileBrowserComponent::openMode | FileBrowserComponent::canSelectFiles,
+                                   [this, side] (const FileChooser& chooser)
+            {
+                const auto file = chooser.getResult();
+                if (file != File() && ! audioProcessor.loadColorationIR(side, file))
+                    AlertWindow::showMessageBoxAsync(AlertWindow::WarningIcon, "Impulse response",
+                                                     "Couldn't read " + file.getFileName());
+                updateColorationIRButtons();
+            });
+        }
+    });
+}
+
+void PingPongDelayAudioProcessorEditor::updateColorationIRButtons()
+{
+    const auto nameL = audioProcessor.getColorationIRName(0);
+    const auto nameR = audioProcessor.getColorationIRName(1);
+    irL_Button.setButtonText(nameL.isNotEmpty() ? nameL : "None");
+    irR_Button.setButtonText(nameR.isNotEmpty() ? nameR : "None");
+}
+
+void PingPongDelayAudioProcessorEditor::timerCallback()
+{
+    // Loads are shown as percentage of the block's real-time budget
+    auto stats = audioProcessor.getCpuLoadStats();
+    
+    String status = "CPU " + String(stats.lastLoad*100.0f, 1) + "%"
+                  + "  p50 " + String(stats.p50*100.0f, 1) + "%"
+                  + "  p99 " + String(stats.p99*100.0f, 1) + "%"
+                  + "  max " + String(stats.max*100.0f, 1) + "%"
+                  + "  misses " + String(stats.deadlineMisses)
+                  + "  resets " + String(audioProcessor.getGuardTrips())
+                  + "  taps " + getTapQualityName(audioProcessor.getTapQuality());
+    
+    // Debug builds: calls that aren't real-time safe made from processBlock
+    if (RealtimeSafetyChecker::isEnabled())
+    {
+        const auto& violations = audioProcessor.getRealtimeViolations();
+        const auto numUnsafe = violations.getCount();
+        status += "  rt-unsafe " + String(numUnsafe);
+        
+        if (numUnsafe > 0)
+            status += String(" (") + violations.getLast() + ")";
+    }
+    
+    cpuLoad_Label.setText(status, juce::dontSendNotification);
+}
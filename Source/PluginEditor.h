@@ -1,63 +1,178 @@
-/*
-  ==============================================================================
-
-    This file contains the basic framework code for a JUCE plugin editor.
-
-  ==============================================================================
-*/
-
-#pragma once
-
-#include <JuceHeader.h>
-#include "PluginProcessor.h"
-
-//==============================================================================
-/**
-*/
-class PingPongDelayAudioProcessorEditor  : public juce::AudioProcessorEditor,
-                                           public juce::Slider::Listener
-{
-public:
-    PingPongDelayAudioProcessorEditor (PingPongDelayAudioProcessor&);
-    ~PingPongDelayAudioProcessorEditor() override;
-
-    //==============================================================================
-    void paint (juce::Graphics&) override;
-    void resized() override;
-    
-    //==============================================================================
-    void sliderValueChanged (Slider* slider) override;
-
-
-private:
-    // This reference is provided as a quick way for your editor to
-    // access the processor object that created it.
-    PingPongDelayAudioProcessor& audioProcessor;
-
-    
-    
-    Slider del_L_Slider;
-    Label del_L_Label;
-    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> del_L_SliderAttachment;
-
-    Slider del_R_Slider;
-    Label del_R_Label;
-    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> del_R_SliderAttachment;
-
-    Slider feedback_L_Slider;
-    Label feedback_L_Label;
-    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> feedback_L_SliderAttachment;
-
-    Slider feedback_R_Slider;
-    Label feedback_R_Label;
-    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> feedback_R_SliderAttachment;
-    
-    Slider drywet_Slider;
-    Label drywet_Label;
-    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> drywet_SliderAttachment;
-    
-    Slider vol_Slider;
-    Label vol_Label;
-    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> vol_SliderAttachment;
-    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PingPongDelayAudioProcessorEditor)
-};
+/*
+  ==============================================================================
+
+    This file contains the basic framework code for a JUCE plugin editor.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+
+//==============================================================================
+/**
+*/
+class PingPongDelayAudioProcessorEditor  : public juce::AudioProcessorEditor,
+                                           public juce::Slider::Listener,
+                                           private juce::Timer
+{
+public:
+    PingPongDelayAudioProcessorEditor (PingPongDelayAudioProcessor&);
+    ~PingPongDelayAudioProcessorEditor() override;
+
+    //==============================================================================
+    void paint (juce::Graphics&) override;
+    void resized() override;
+    
+    //==============================================================================
+    void sliderValueChanged (Slider* slider) override;
+
+    //==============================================================================
+    void timerCallback() override;
+
+
+private:
+    // This reference is provided as a quick way for your editor to
+    // access the processor object that created it.
+    PingPongDelayAudioProcessor& audioProcessor;
+    
+    // Controls laid out one per row by resized()
+    std::vector<juce::Component*> getRowComponents();
+
+    
+    
+    Slider del_L_Slider;
+    Label del_L_Label;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> del_L_SliderAttachment;
+
+    Slider del_R_Slider;
+    Label del_R_Label;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> del_R_SliderAttachment;
+
+    Slider feedback_L_Slider;
+    Label feedback_L_Label;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> feedback_L_SliderAttachment;
+
+    Slider feedback_R_Slider;
+    Label feedback_R_Label;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> feedback_R_SliderAttachment;
+    
+    Slider drywet_Slider;
+    Label drywet_Label;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> drywet_SliderAttachment;
+    
+    Slider vol_Slider;
+    Label vol_Label;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> vol_SliderAttachment;
+    
+    ComboBox timeMode_Box;
+    Label timeMode_Label;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> timeMode_BoxAttachment;
+    
+    Slider fadeTime_Slider;
+    Label fadeTime_Label;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> fadeTime_SliderAttachment;
+    
+    Slider tapeRate_Slider;
+    Label tapeRate_Label;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> tapeRate_SliderAttachment;
+    
+    ToggleButton longMode_Button;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> longMode_ButtonAttachment;
+    
+    Slider longDel_L_Slider;
+    Label longDel_L_Label;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> longDel_L_SliderAttachment;
+    
+    Slider longDel_R_Slider;
+    Label longDel_R_Label;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> longDel_R_SliderAttachment;
+    
+    ToggleButton freeze_Button;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> freeze_ButtonAttachment;
+    
+    ToggleButton softLimit_Button;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> softLimit_ButtonAttachment;
+    
+    Slider diffusion_Slider;
+    Label diffusion_Label;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> diffusion_SliderAttachment;
+    
+    Slider shimmer_Slider;
+    Label shimmer_Label;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> shimmer_SliderAttachment;
+    
+    ComboBox shimmerPitch_Box;
+    Label shimmerPitch_Label;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> shimmerPitch_BoxAttachment;
+    
+    ToggleButton reverse_Button;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> reverse_ButtonAttachment;
+    
+    Slider drive_Slider;
+    Label drive_Label;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> drive_SliderAttachment;
+    
+    ComboBox bands_Box;
+    Label bands_Label;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> bands_BoxAttachment;
+    
+    Slider crossoverLow_Slider;
+    Label crossoverLow_Label;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> crossoverLow_SliderAttachment;
+    
+    Slider crossoverHigh_Slider;
+    Label crossoverHigh_Label;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> crossoverHigh_SliderAttachment;
+    
+    // Low, mid, high
+    Slider bandDel_Sliders[3];
+    Label bandDel_Labels[3];
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> bandDel_SliderAttachments[3];
+    
+    Slider bandFeedback_Sliders[3];
+    Label bandFeedback_Labels[3];
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> bandFeedback_SliderAttachments[3];
+    
+    Slider duckAmount_Slider;
+    Label duckAmount_Label;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> duckAmount_SliderAttachment;
+    
+    Slider duckAttack_Slider;
+    Label duckAttack_Label;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> duckAttack_SliderAttachment;
+    
+    Slider duckRelease_Slider;
+    Label duckRelease_Label;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> duckRelease_SliderAttachment;
+    
+    Slider duckThreshold_Slider;
+    Label duckThreshold_Label;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> duckThreshold_SliderAttachment;
+    
+    ComboBox fdnLines_Box;
+    Label fdnLines_Label;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> fdnLines_BoxAttachment;
+    
+    ComboBox fdnMatrix_Box;
+    Label fdnMatrix_Label;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> fdnMatrix_BoxAttachment;
+    
+    // Coloration IR per side: a menu to load or clear it, showing its name
+    TextButton irL_Button, irR_Button;
+    Label irL_Label, irR_Label;
+    std::unique_ptr<juce::FileChooser> irChooser;
+    void showColorationIRMenu (int side);
+    void updateColorationIRButtons();
+    
+    ComboBox storage_Box;
+    Label storage_Label;
+    
+    ComboBox economy_Box;
+    Label economy_Label;
+    
+    Label cpuLoad_Label;
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PingPongDelayAudioProcessorEditor)
+};
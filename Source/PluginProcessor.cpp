@@ -1,481 +1,627 @@
-/*
-  ==============================================================================
-
-    This file contains the basic framework code for a JUCE plugin processor.
-
-  ==============================================================================
-*/
-
-#include "PluginProcessor.h"
-#include "PluginEditor.h"
-
-//------------------------------------------------------------
-double linearMapping(float rangeIn_top, float rangeIn_bottom, float rangeOut_top, float rangeOut_bottom, float value) {
-    double newValue = rangeOut_bottom + ((rangeOut_top - rangeOut_bottom) * (value - rangeIn_bottom) / (rangeIn_top - rangeIn_bottom));
-    return newValue;
-}
-//------------------------------------------------------------
-
-//==============================================================================
-PingPongDelayAudioProcessor::PingPongDelayAudioProcessor()
-#ifndef JucePlugin_PreferredChannelConfigurations
-     : AudioProcessor (BusesProperties()
-                     #if ! JucePlugin_IsMidiEffect
-                      #if ! JucePlugin_IsSynth
-                       .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
-                      #endif
-                       .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
-                     #endif
-                       ), apvts(*this, nullptr, "Parameters", createParameters())
-#endif
-{
-}
-
-PingPongDelayAudioProcessor::~PingPongDelayAudioProcessor()
-{
-}
-
-//==============================================================================
-const juce::String PingPongDelayAudioProcessor::getName() const
-{
-    return JucePlugin_Name;
-}
-
-bool PingPongDelayAudioProcessor::acceptsMidi() const
-{
-   #if JucePlugin_WantsMidiInput
-    return true;
-   #else
-    return false;
-   #endif
-}
-
-bool PingPongDelayAudioProcessor::producesMidi() const
-{
-   #if JucePlugin_ProducesMidiOutput
-    return true;
-   #else
-    return false;
-   #endif
-}
-
-bool PingPongDelayAudioProcessor::isMidiEffect() const
-{
-   #if JucePlugin_IsMidiEffect
-    return true;
-   #else
-    return false;
-   #endif
-}
-
-double PingPongDelayAudioProcessor::getTailLengthSeconds() const
-{
-    return 0.0;
-}
-
-int PingPongDelayAudioProcessor::getNumPrograms()
-{
-    return 1;   // NB: some hosts don't cope very well if you tell them there are 0 programs,
-                // so this should be at least 1, even if you're not really implementing programs.
-}
-
-int PingPongDelayAudioProcessor::getCurrentProgram()
-{
-    return 0;
-}
-
-void PingPongDelayAudioProcessor::setCurrentProgram (int index)
-{
-}
-
-const juce::String PingPongDelayAudioProcessor::getProgramName (int index)
-{
-    return {};
-}
-
-void PingPongDelayAudioProcessor::changeProgramName (int index, const juce::String& newName)
-{
-}
-
-//==============================================================================
-void PingPongDelayAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
-{
-    // Print sample rate -- for checking purposes
-    gSampleRate = sampleRate;
-    T = 1/gSampleRate;
-    Logger::getCurrentLogger()->outputDebugString("Sample rate is " + String(sampleRate) + ".");
-    
-    // Read parameters from sliders
-    auto* selection_del_L = dynamic_cast<AudioParameterFloat*> (apvts.getParameter ("DEL_L"));
-    del_L_param = selection_del_L->get();
-    del_L_param = 0.0; // overwriting.. just in case
-    del_L_param_prev = 0.0; // overwriting.. just in case
-
-    auto* selection_del_R = dynamic_cast<AudioParameterFloat*> (apvts.getParameter ("DEL_R"));
-    del_R_param = selection_del_R->get();
-    del_R_param = 0.0; // overwriting.. just in case
-    del_R_param_prev = 0.0; // overwriting.. just in case
-
-    auto* selection_feedback_L = dynamic_cast<AudioParameterFloat*> (apvts.getParameter ("FEEDBACK_L"));
-    feedback_L_param = selection_feedback_L->get();
-    feedback_L_param = 0.0; // overwriting.. just in case
-    feedback_L_param_prev = 0.0; // overwriting.. just in case
-
-    auto* selection_feedback_R = dynamic_cast<AudioParameterFloat*> (apvts.getParameter ("FEEDBACK_R"));
-    feedback_R_param = selection_feedback_R->get();
-    feedback_R_param = 0.0; // overwriting.. just in case
-    feedback_R_param_prev = 0.0; // overwriting.. just in case
-
-    auto* selection_drywet = dynamic_cast<AudioParameterFloat*> (apvts.getParameter ("DRY_WET"));
-    gDryWet_param = selection_drywet->get();
-    gDryWet_param = 0.0; // overwriting.. just in case
-    gDryWet_param_prev = 0.0; // overwriting.. just in case
-
-    gVolume_param = 0.0;
-    
-    // Resizing buffers and preallocating read and write pointers
-    gDelayBuffer_inSig.resize(2); // 2 channels
-    for (int i = 0; i < 2; ++i)
-        gDelayBuffer_inSig[i].resize(BUFFER_SIZE,0);
-    
-    gDelayBuffer_crossSig.resize(2); // 2 channels
-    for (int i = 0; i < 2; ++i)
-        gDelayBuffer_crossSig[i].resize(BUFFER_SIZE,0);
- 
-    gInitLatency = 8;
-    
-    gWritePointer_inSig.resize(2,gInitLatency);
-    gReadPointer_inSig.resize(2,0);
-    
-    gWritePointer_crossSig.resize(2,gInitLatency);
-    gReadPointer_crossSig.resize(2,0);
-    
-    outVal.resize(2,0);
-    outValDry.resize(2,0);
-
-}
-
-void PingPongDelayAudioProcessor::releaseResources()
-{
-    // When playback stops, you can use this as an opportunity to free up any
-    // spare memory, etc.
-}
-
-#ifndef JucePlugin_PreferredChannelConfigurations
-bool PingPongDelayAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
-{
-  #if JucePlugin_IsMidiEffect
-    juce::ignoreUnused (layouts);
-    return true;
-  #else
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
-        return false;
-
-    // This checks if the input layout matches the output layout
-   #if ! JucePlugin_IsSynth
-    if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
-        return false;
-   #endif
-
-    return true;
-  #endif
-}
-#endif
-
-void PingPongDelayAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
-{
-    juce::ScopedNoDenormals noDenormals;
-    auto totalNumInputChannels  = getTotalNumInputChannels();
-    auto totalNumOutputChannels = getTotalNumOutputChannels();
-
-    float* const outputL = buffer.getWritePointer(0);
-    float* const outputR = buffer.getWritePointer(1);
-
-    for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
-        buffer.clear (i, 0, buffer.getNumSamples());
-
-
-//    Logger::getCurrentLogger()->outputDebugString("gFactDry is " + String(gFactDry) + ".");
-//    Logger::getCurrentLogger()->outputDebugString("gFactWet is " + String(gFactWet) + ".");
-//    Logger::getCurrentLogger()->outputDebugString("gDryWet_param is " + String(gDryWet_param) + ".");
-//    Logger::getCurrentLogger()->outputDebugString("drywet is " + String(drywet) + ".");
-
-    // This is the place where you'd normally do the guts of your plugin's
-    // audio processing...
-    // Make sure to reset the state if your inner loop is processing
-    // the samples and the outer loop is handling the channels.
-    // Alternatively, you can process the samples with the channels
-    // interleaved by keeping the same state.
-    
-
-    
-    for (int i = 0; i < buffer.getNumSamples(); ++i)
-    {
-
-        // READ PARAMS
-        del_L = (1-0.99)*del_L_param + 0.99*del_L_param_prev;
-        del_L_param_prev = del_L;
-        
-//        Logger::getCurrentLogger()->outputDebugString("del_L is " + String(del_L) + ".");
-
-        
-        del_R = (1-0.99)*del_R_param + 0.99*del_R_param_prev;
-        del_R_param_prev = del_R;
-        
-        for (int channel = 0; channel < 2; ++channel) // doing this because im overwriting the first channel after going through the first iteration of the loop !
-        {
-            auto* input = buffer.getWritePointer (channel);
-
-            // Current input sample
-            float in = input[i];
-            
-            outValDry[channel] = in; // Dry output
-            
-            
-
-            feedback_L = (1-0.8)*feedback_L_param + 0.8*feedback_L_param_prev;
-            feedback_L_param_prev = feedback_L_param;
-            
-            feedback_R = (1-0.8)*feedback_R_param + 0.8*feedback_R_param_prev;
-            feedback_R_param_prev = feedback_R_param;
-            
-            gDryWet = (1-0.8)*gDryWet_param + 0.8*gDryWet_param_prev;
-            gDryWet_param_prev = gDryWet_param;
-            
-            // delays in samples
-            float del_L_samples = floor(del_L*gSampleRate/1000);
-            float del_L_frac_part = del_L*gSampleRate/1000 - del_L_samples;
-            float del_R_samples = floor(del_R*gSampleRate/1000);
-            float del_R_frac_part = del_R*gSampleRate/1000 - del_R_samples;
-            
-            if (channel == 0)
-            {
-                gDelayBuffer_inSig[channel][gWritePointer_inSig[channel]] = in;
-                
-//                int index = (int)floorf(gReadPointer_inSig[channel]);
-//                float alpha = gReadPointer_inSig[channel] - index;
-                
-                int index = (gReadPointer_inSig[channel] - static_cast<int>(del_L_samples) + BUFFER_SIZE) % BUFFER_SIZE;
-                int index_m1 = (gReadPointer_inSig[channel] - static_cast<int>(del_L_samples) - 1 + BUFFER_SIZE) % BUFFER_SIZE;
-                int index_p1 = (gReadPointer_inSig[channel] - static_cast<int>(del_L_samples) + 1 + BUFFER_SIZE) % BUFFER_SIZE;
-                int index_p2 = (gReadPointer_inSig[channel] - static_cast<int>(del_L_samples) + 2 + BUFFER_SIZE) % BUFFER_SIZE;
-                
-                float alpha = del_L_frac_part;
-                
-                inSig_L_del_L = ( alpha*(alpha-1)*(alpha-2)*gDelayBuffer_inSig[channel][index_m1]/(-6)
-                                         + (alpha-1)*(alpha+1)*(alpha-2)*gDelayBuffer_inSig[channel][index]/2
-                                         + alpha*(alpha+1)*(alpha-2)*gDelayBuffer_inSig[channel][index_p1]/(-2)
-                                         + alpha*(alpha+1)*(alpha-1)*gDelayBuffer_inSig[channel][index_p2]/(6) );
-                
-//                int outPointer_L = (gReadPointer_inSig[channel] - 1 - static_cast<int>(del_L_samples) + BUFFER_SIZE) % BUFFER_SIZE;
-//                int outPointer_L_frac = (gReadPointer_inSig[channel] - static_cast<int>(del_L_samples) + BUFFER_SIZE) % BUFFER_SIZE;
-                
-//                inSig_L_del_L = del_L_frac_part*gDelayBuffer_inSig[channel][outPointer_L] + (1-del_L_frac_part)*gDelayBuffer_inSig[channel][outPointer_L_frac];
-
-                crossSig_L = a1*inSig_L_del_L + feedback_L*crossSig_R_del_L;
-                
-                gDelayBuffer_crossSig[channel][gWritePointer_crossSig[channel]] = crossSig_L;
-
-//                int outPointer_L_cross = (gReadPointer_crossSig[channel] - 1 - static_cast<int>(del_L_samples) + BUFFER_SIZE) % BUFFER_SIZE;
-//                int outPointer_L_cross_frac = (gReadPointer_crossSig[channel] - static_cast<int>(del_L_samples) + BUFFER_SIZE) % BUFFER_SIZE;
-                
-                index = (gReadPointer_crossSig[channel] - static_cast<int>(del_L_samples) + BUFFER_SIZE) % BUFFER_SIZE;
-                index_m1 = (gReadPointer_crossSig[channel] - static_cast<int>(del_L_samples) - 1 + BUFFER_SIZE) % BUFFER_SIZE;
-                index_p1 = (gReadPointer_crossSig[channel] - static_cast<int>(del_L_samples) + 1 + BUFFER_SIZE) % BUFFER_SIZE;
-                index_p2 = (gReadPointer_crossSig[channel] - static_cast<int>(del_L_samples) + 2 + BUFFER_SIZE) % BUFFER_SIZE;
-                alpha = del_L_frac_part;
-
-                crossSig_L_del_L = ( alpha*(alpha-1)*(alpha-2)*gDelayBuffer_crossSig[channel][index_m1]/(-6)
-                                         + (alpha-1)*(alpha+1)*(alpha-2)*gDelayBuffer_crossSig[channel][index]/2
-                                         + alpha*(alpha+1)*(alpha-2)*gDelayBuffer_crossSig[channel][index_p1]/(-2)
-                                         + alpha*(alpha+1)*(alpha-1)*gDelayBuffer_crossSig[channel][index_p2]/(6) );
-                
-                
-                index = (gReadPointer_crossSig[channel] - static_cast<int>(del_R_samples) + BUFFER_SIZE) % BUFFER_SIZE;
-                index_m1 = (gReadPointer_crossSig[channel] - static_cast<int>(del_R_samples) - 1 + BUFFER_SIZE) % BUFFER_SIZE;
-                index_p1 = (gReadPointer_crossSig[channel] - static_cast<int>(del_R_samples) + 1 + BUFFER_SIZE) % BUFFER_SIZE;
-                index_p2 = (gReadPointer_crossSig[channel] - static_cast<int>(del_R_samples) + 2 + BUFFER_SIZE) % BUFFER_SIZE;
-                alpha = del_R_frac_part;
-                
-                crossSig_L_del_R = ( alpha*(alpha-1)*(alpha-2)*gDelayBuffer_crossSig[channel][index_m1]/(-6)
-                                         + (alpha-1)*(alpha+1)*(alpha-2)*gDelayBuffer_crossSig[channel][index]/2
-                                         + alpha*(alpha+1)*(alpha-2)*gDelayBuffer_crossSig[channel][index_p1]/(-2)
-                                         + alpha*(alpha+1)*(alpha-1)*gDelayBuffer_crossSig[channel][index_p2]/(6) );
-                
-//                int outPointer_R_cross = (gReadPointer_crossSig[channel] - 1 - static_cast<int>(del_R_samples) + BUFFER_SIZE) % BUFFER_SIZE;
-//                int outPointer_R_cross_frac = (gReadPointer_crossSig[channel] - static_cast<int>(del_R_samples) + BUFFER_SIZE) % BUFFER_SIZE;
-                
-//                crossSig_L_del_R = del_R_frac_part*gDelayBuffer_crossSig[channel][outPointer_R_cross] + (1-del_R_frac_part)*gDelayBuffer_crossSig[channel][outPointer_R_cross_frac];
-//                crossSig_L_del_L = del_L_frac_part*gDelayBuffer_crossSig[channel][outPointer_L_cross] + (1-del_L_frac_part)*gDelayBuffer_crossSig[channel][outPointer_L_cross_frac];
-                
-                outVal[channel] = in + c1*crossSig_L;
-            }
-            else if (channel == 1)
-            {
-                gDelayBuffer_inSig[channel][gWritePointer_inSig[channel]] = in;
-                
-//                int outPointer_R = (gReadPointer_inSig[channel] - 1 - static_cast<int>(del_R_samples) + BUFFER_SIZE) % BUFFER_SIZE;
-//                int outPointer_R_frac = (gReadPointer_inSig[channel] - static_cast<int>(del_R_samples) + BUFFER_SIZE) % BUFFER_SIZE;
-                
-                int index = (gReadPointer_inSig[channel] - static_cast<int>(del_R_samples) + BUFFER_SIZE) % BUFFER_SIZE;
-                int index_m1 = (gReadPointer_inSig[channel] - static_cast<int>(del_R_samples) - 1 + BUFFER_SIZE) % BUFFER_SIZE;
-                int index_p1 = (gReadPointer_inSig[channel] - static_cast<int>(del_R_samples) + 1 + BUFFER_SIZE) % BUFFER_SIZE;
-                int index_p2 = (gReadPointer_inSig[channel] - static_cast<int>(del_R_samples) + 2 + BUFFER_SIZE) % BUFFER_SIZE;
-                float alpha = del_R_frac_part;
-                
-                inSig_R_del_R = ( alpha*(alpha-1)*(alpha-2)*gDelayBuffer_inSig[channel][index_m1]/(-6)
-                                         + (alpha-1)*(alpha+1)*(alpha-2)*gDelayBuffer_inSig[channel][index]/2
-                                         + alpha*(alpha+1)*(alpha-2)*gDelayBuffer_inSig[channel][index_p1]/(-2)
-                                         + alpha*(alpha+1)*(alpha-1)*gDelayBuffer_inSig[channel][index_p2]/(6) );
-                
-//                inSig_R_del_R = del_R_frac_part*gDelayBuffer_inSig[channel][outPointer_R] + (1-del_R_frac_part)*gDelayBuffer_inSig[channel][outPointer_R_frac];
-
-                crossSig_R = a2*inSig_R_del_R + feedback_R*crossSig_L_del_R;
-                
-                gDelayBuffer_crossSig[channel][gWritePointer_crossSig[channel]] = crossSig_R;
-
-                index = (gReadPointer_crossSig[channel] - static_cast<int>(del_R_samples) + BUFFER_SIZE) % BUFFER_SIZE;
-                index_m1 = (gReadPointer_crossSig[channel] - static_cast<int>(del_R_samples) - 1 + BUFFER_SIZE) % BUFFER_SIZE;
-                index_p1 = (gReadPointer_crossSig[channel] - static_cast<int>(del_R_samples) + 1 + BUFFER_SIZE) % BUFFER_SIZE;
-                index_p2 = (gReadPointer_crossSig[channel] - static_cast<int>(del_R_samples) + 2 + BUFFER_SIZE) % BUFFER_SIZE;
-                alpha = del_R_frac_part;
-                
-                
-                crossSig_R_del_R = ( alpha*(alpha-1)*(alpha-2)*gDelayBuffer_crossSig[channel][index_m1]/(-6)
-                                         + (alpha-1)*(alpha+1)*(alpha-2)*gDelayBuffer_crossSig[channel][index]/2
-                                         + alpha*(alpha+1)*(alpha-2)*gDelayBuffer_crossSig[channel][index_p1]/(-2)
-                                         + alpha*(alpha+1)*(alpha-1)*gDelayBuffer_crossSig[channel][index_p2]/(6) );
-                
-                
-                index = (gReadPointer_crossSig[channel] - static_cast<int>(del_L_samples) + BUFFER_SIZE) % BUFFER_SIZE;
-                index_m1 = (gReadPointer_crossSig[channel] - static_cast<int>(del_L_samples) - 1 + BUFFER_SIZE) % BUFFER_SIZE;
-                index_p1 = (gReadPointer_crossSig[channel] - static_cast<int>(del_L_samples) + 1 + BUFFER_SIZE) % BUFFER_SIZE;
-                index_p2 = (gReadPointer_crossSig[channel] - static_cast<int>(del_L_samples) + 2 + BUFFER_SIZE) % BUFFER_SIZE;
-                alpha = del_L_frac_part;
-                
-                
-                crossSig_R_del_L = ( alpha*(alpha-1)*(alpha-2)*gDelayBuffer_crossSig[channel][index_m1]/(-6)
-                                         + (alpha-1)*(alpha+1)*(alpha-2)*gDelayBuffer_crossSig[channel][index]/2
-                                         + alpha*(alpha+1)*(alpha-2)*gDelayBuffer_crossSig[channel][index_p1]/(-2)
-                                         + alpha*(alpha+1)*(alpha-1)*gDelayBuffer_crossSig[channel][index_p2]/(6) );
-                
-                
-//                int outPointer_L_cross = (gReadPointer_crossSig[channel] - 1 - static_cast<int>(del_L_samples) + BUFFER_SIZE) % BUFFER_SIZE;
-//                int outPointer_L_cross_frac = (gReadPointer_crossSig[channel] - static_cast<int>(del_L_samples) + BUFFER_SIZE) % BUFFER_SIZE;
-//                int outPointer_R_cross = (gReadPointer_crossSig[channel] - 1 - static_cast<int>(del_R_samples) + BUFFER_SIZE) % BUFFER_SIZE;
-//                int outPointer_R_cross_frac = (gReadPointer_crossSig[channel] - static_cast<int>(del_R_samples) + BUFFER_SIZE) % BUFFER_SIZE;
-//
-//                crossSig_R_del_R = del_R_frac_part*gDelayBuffer_crossSig[channel][outPointer_R_cross] + (1-del_R_frac_part)*gDelayBuffer_crossSig[channel][outPointer_R_cross_frac];
-//                crossSig_R_del_L = del_L_frac_part*gDelayBuffer_crossSig[channel][outPointer_L_cross] + (1-del_L_frac_part)*gDelayBuffer_crossSig[channel][outPointer_L_cross_frac];
-                
-                outVal[channel] = in + c2*crossSig_R;
-            }
-            
-            // update gWritePointer
-            gWritePointer_inSig[channel] = gWritePointer_inSig[channel] + 1;
-            if (gWritePointer_inSig[channel] >= BUFFER_SIZE)
-                gWritePointer_inSig[channel] = 0;
-
-            // update gReadPointer
-            gReadPointer_inSig[channel] = gReadPointer_inSig[channel] + 1;
-            if (gReadPointer_inSig[channel] >= BUFFER_SIZE)
-                gReadPointer_inSig[channel] = 0;
-            
-            // update gWritePointer_head_shadow
-            gWritePointer_crossSig[channel] = gWritePointer_crossSig[channel] + 1;
-            if (gWritePointer_crossSig[channel] >= BUFFER_SIZE)
-                gWritePointer_crossSig[channel] = 0;
-
-            // update gReadPointer_head_shadow
-            gReadPointer_crossSig[channel] = gReadPointer_crossSig[channel] + 1;
-            if (gReadPointer_crossSig[channel] >= BUFFER_SIZE)
-                gReadPointer_crossSig[channel] = 0;
-            
-            
-//
-//            if (abs((outVal_post_pinnae[channel])) > 1)
-//            {
-//                Logger::getCurrentLogger()->outputDebugString("Output is too loud!");
-//            }
-            
-            
-            drywet = linearMapping(1.0f, 0.0f, 1.0f, -1.0f, gDryWet);
-            
-            if(drywet<-1.0)
-            {
-                drywet = -1.0;
-            }else if (drywet>0.99)
-            {
-                drywet = 1.0;
-            }
-            
-            gFactDry = (powf(0.5*(1.0-drywet),0.5));
-            gFactWet = (powf(0.5*(1.0+drywet),0.5));
-            
-//            Logger::getCurrentLogger()->outputDebugString("gFactDry is " + String(gFactDry) + ".");
-//            Logger::getCurrentLogger()->outputDebugString("gFactWet is " + String(gFactWet) + ".");
-
-            
-            if (channel == 0)
-            {
-//                output = (output * gFactWet + output_dry * gFactDry);
-
-                outputL[i] = (outVal[channel] * gFactWet + outValDry[channel] * gFactDry) * powf(10,(gVolume_param/20));
-//                outputL[i] = (outVal_post_pinnae[channel]) * 1.0;
-//                outputL[i] = (outVal_head_shadow[channel]) * 1.0;
-                if (abs(outputL[i]) > 1)
-                {
-                    Logger::getCurrentLogger()->outputDebugString("Output left is too loud!");
-                }
-            }
-            else if (channel == 1)
-            {
-                outputR[i] = (outVal[channel] * gFactWet + outValDry[channel] * gFactDry) * powf(10,(gVolume_param/20));
-//                outputR[i] = (outVal_post_pinnae[channel]) * 1.0;
-//                outputR[i] = (outVal_head_shadow[channel]) * 1.0;
-                if (abs(outputR[i]) > 1)
-                {
-                    Logger::getCurrentLogger()->outputDebugString("Output right is too loud!");
-                }
-            }
-        }
-        // ..do something to the data...
-    }
-}
-
-//==============================================================================
-bool PingPongDelayAudioProcessor::hasEditor() const
-{
-    return true; // (change this to false if you choose to not supply an editor)
-}
-
-juce::AudioProcessorEditor* PingPongDelayAudioProcessor::createEditor()
-{
-    return new PingPongDelayAudioProcessorEditor (*this);
-}
-
-//==============================================================================
-void PingPongDelayAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
-{
-    // You should use this method to store your parameters in the memory block.
-    // You could do that either as raw data, or use the XML or ValueTree classes
-    // as intermediaries to make it easy to save and load complex data.
-}
-
-void PingPongDelayAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
-{
-    // You should use this method to restore your parameters from this memory block,
-    // whose contents will have been created by the getStateInformation() call.
-}
-
-//==============================================================================
-// This creates new instances of the plugin..
-juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
-{
-    return new PingPongDelayAudioProcessor();
-}
+/*
+  ==============================================================================
+
+    This file contains the basic framework code for a JUCE plugin processor.
+
+  ==============================================================================
+*/
+
+#include "PluginProcessor.h"
+#include "PluginEditor.h"
+
+//==============================================================================
+PingPongDelayAudioProcessor::PingPongDelayAudioProcessor()
+#ifndef JucePlugin_PreferredChannelConfigurations
+     : AudioProcessor (BusesProperties()
+                     #if ! JucePlugin_IsMidiEffect
+                      #if ! JucePlugin_IsSynth
+                       .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
+                       .withInput  ("Sidechain", juce::AudioChannelSet::stereo(), false)
+                      #endif
+                       .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
+                     #endif
+                       ), apvts(*this, nullptr, "Parameters", createParameters())
+#endif
+{
+    longModeParam = apvts.getRawParameterValue("LONG_MODE");
+    longDel_L_Param = apvts.getRawParameterValue("LONG_DEL_L");
+    longDel_R_Param = apvts.getRawParameterValue("LONG_DEL_R");
+    freezeParam = apvts.getRawParameterValue("FREEZE");
+    softLimitParam = apvts.getRawParameterValue("SOFT_LIMIT");
+    fdnLinesParam = apvts.getRawParameterValue("FDN_LINES");
+    fdnMatrixParam = apvts.getRawParameterValue("FDN_MATRIX");
+    diffusionParam = apvts.getRawParameterValue("DIFFUSION");
+    shimmerParam = apvts.getRawParameterValue("SHIMMER");
+    shimmerPitchParam = apvts.getRawParameterValue("SHIMMER_PITCH");
+    reverseParam = apvts.getRawParameterValue("REVERSE");
+    driveParam = apvts.getRawParameterValue("DRIVE");
+    bandsParam = apvts.getRawParameterValue("BANDS");
+    crossoverLowParam = apvts.getRawParameterValue("CROSSOVER_LOW");
+    crossoverHighParam = apvts.getRawParameterValue("CROSSOVER_HIGH");
+    bandDelayParams[0] = apvts.getRawParameterValue("BAND_DEL_LOW");
+    bandDelayParams[1] = apvts.getRawParameterValue("BAND_DEL_MID");
+    bandDelayParams[2] = apvts.getRawParameterValue("BAND_DEL_HIGH");
+    bandFeedbackParams[0] = apvts.getRawParameterValue("BAND_FEEDBACK_LOW");
+    bandFeedbackParams[1] = apvts.getRawParameterValue("BAND_FEEDBACK_MID");
+    bandFeedbackParams[2] = apvts.getRawParameterValue("BAND_FEEDBACK_HIGH");
+    duckAmountParam = apvts.getRawParameterValue("DUCK_AMOUNT");
+    duckAttackParam = apvts.getRawParameterValue("DUCK_ATTACK");
+    duckReleaseParam = apvts.getRawParameterValue("DUCK_RELEASE");
+    duckThresholdParam = apvts.getRawParameterValue("DUCK_THRESHOLD");
+    timeModeParam = apvts.getRawParameterValue("TIME_MODE");
+    fadeTimeParam = apvts.getRawParameterValue("FADE_TIME");
+    tapeRateParam = apvts.getRawParameterValue("TAPE_RATE");
+}
+
+PingPongDelayAudioProcessor::~PingPongDelayAudioProcessor()
+{
+}
+
+//==============================================================================
+const juce::String PingPongDelayAudioProcessor::getName() const
+{
+    return JucePlugin_Name;
+}
+
+bool PingPongDelayAudioProcessor::acceptsMidi() const
+{
+   #if JucePlugin_WantsMidiInput
+    return true;
+   #else
+    return false;
+   #endif
+}
+
+bool PingPongDelayAudioProcessor::producesMidi() const
+{
+   #if JucePlugin_ProducesMidiOutput
+    return true;
+   #else
+    return false;
+   #endif
+}
+
+bool PingPongDelayAudioProcessor::isMidiEffect() const
+{
+   #if JucePlugin_IsMidiEffect
+    return true;
+   #else
+    return false;
+   #endif
+}
+
+double PingPongDelayAudioProcessor::getTailLengthSeconds() const
+{
+    return 0.0;
+}
+
+int PingPongDelayAudioProcessor::getNumPrograms()
+{
+    return 1;   // NB: some hosts don't cope very well if you tell them there are 0 programs,
+                // so this should be at least 1, even if you're not really implementing programs.
+}
+
+int PingPongDelayAudioProcessor::getCurrentProgram()
+{
+    return 0;
+}
+
+void PingPongDelayAudioProcessor::setCurrentProgram (int index)
+{
+}
+
+const juce::String PingPongDelayAudioProcessor::getProgramName (int index)
+{
+    return {};
+}
+
+void PingPongDelayAudioProcessor::changeProgramName (int index, const juce::String& newName)
+{
+}
+
+//==============================================================================
+void PingPongDelayAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
+{
+    // Print sample rate -- for checking purposes
+    Logger::getCurrentLogger()->outputDebugString("Sample rate is " + String(sampleRate) + ".");
+    
+    // Read parameters from sliders
+    auto* selection_del_L = dynamic_cast<AudioParameterFloat*> (apvts.getParameter ("DEL_L"));
+    del_L_param = selection_del_L->get();
+    del_L_param = 0.0; // overwriting.. just in case
+
+    auto* selection_del_R = dynamic_cast<AudioParameterFloat*> (apvts.getParameter ("DEL_R"));
+    del_R_param = selection_del_R->get();
+    del_R_param = 0.0; // overwriting.. just in case
+
+    auto* selection_feedback_L = dynamic_cast<AudioParameterFloat*> (apvts.getParameter ("FEEDBACK_L"));
+    feedback_L_param = selection_feedback_L->get();
+    feedback_L_param = 0.0; // overwriting.. just in case
+
+    auto* selection_feedback_R = dynamic_cast<AudioParameterFloat*> (apvts.getParameter ("FEEDBACK_R"));
+    feedback_R_param = selection_feedback_R->get();
+    feedback_R_param = 0.0; // overwriting.. just in case
+
+    auto* selection_drywet = dynamic_cast<AudioParameterFloat*> (apvts.getParameter ("DRY_WET"));
+    gDryWet_param = selection_drywet->get();
+    gDryWet_param = 0.0; // overwriting.. just in case
+
+    gVolume_param = 0.0;
+    
+    // Leasing delay buffers from the shared pool. The lease is kept across
+    // re-prepares (a new one only if this rate needs more room) and handed back
+    // in releaseResources().
+    preparedSampleRate = sampleRate;
+    allocateDelayMemory();
+    
+    // Smoothing and time modes start from zero, the delay contents are kept
+    engine.prepare(sampleRate);
+    prepareColorationIRs();
+
+    cpuLoadMeter.prepare(sampleRate);
+    rtViolations.reset();
+    
+    // Long delay lines only need rebuilding when the rate changes
+    if (! longDelayStorage.isPrepared() || longDelayPreparedRate != sampleRate)
+    {
+        longDelayStorage.prepare(4, (int) (LONG_DELAY_MAX_SECONDS*sampleRate) + 2*LongDelayStorage::CHUNK_SIZE,
+                                 longDelayRamLimitBytes, longDelaySpillDirectory);
+        longDelayPreparedRate = sampleRate;
+    }
+}
+
+void PingPongDelayAudioProcessor::releaseResources()
+{
+    // When playback stops, you can use this as an opportunity to free up any
+    // spare memory, etc.
+    
+    // With PINGPONG_RT_CHECKS (Debug builds): something in processBlock
+    // allocated, locked or did file I/O since prepareToPlay(), see
+    // getRealtimeViolations().getLast()
+    jassert (rtViolations.getCount() == 0);
+    
+    // The delay memory goes back to the shared pool, where the next instance
+    // (or this one, on the next prepareToPlay) picks it up already cleared.
+    freeDelayMemory();
+    longDelayStorage.release();
+}
+
+void PingPongDelayAudioProcessor::reset()
+{
+    // Transport jumps and the like. The engine's reset is constant time, so it
+    // runs on the audio thread at the start of the next block.
+    resetPending = true;
+}
+
+//==============================================================================
+int PingPongDelayAudioProcessor::getDelayBufferSize() const
+{
+    // In Economy mode the same delay times fit in 1/economyFactor of the samples
+    const double networkRate = preparedSampleRate / economyFactor;
+    const int needed = PingPongEngine::getBufferSizeFor((int) std::ceil(MAX_DELAY_MS*networkRate/1000) + 1, networkRate);
+    
+    return jmax(BUFFER_SIZE / economyFactor, needed);
+}
+
+void PingPongDelayAudioProcessor::allocateDelayMemory()
+{
+    const int bufferSize = getDelayBufferSize();
+    const size_t required = PingPongEngine::getRequiredMemory(bufferSize, delayStorageFormat);
+    
+    // Big enough already: only the layout may change. The old contents don't
+    // need clearing, the engine's reset() makes them read as silence.
+    if (delayMemory.isValid() && delayMemory.getNumBytes() >= required)
+    {
+        if (bufferSize != engine.getBufferSize() || delayStorageFormat != engine.getDelayStorageFormat())
+        {
+            engine.setDelayMemory(delayMemory.getData(), bufferSize, delayStorageFormat);
+            engine.reset();
+        }
+        return;
+    }
+    
+    // One block holds all four buffers, laid out by the engine
+    delayMemory.reset();
+    delayMemory = delayMemoryPool->acquire(required);
+    jassert(delayMemory.isValid());
+    
+    engine.setDelayMemory(delayMemory.getData(), bufferSize, delayStorageFormat);
+}
+
+void PingPongDelayAudioProcessor::freeDelayMemory()
+{
+    engine.setDelayMemory(nullptr, getDelayBufferSize(), delayStorageFormat);
+    delayMemory.reset();
+}
+
+void PingPongDelayAudioProcessor::setDelayStorageFormat (DelaySampleFormat newFormat)
+{
+    if (newFormat == delayStorageFormat)
+        return;
+    
+    // Swapping the storage under a running callback isn't possible, so stop the
+    // audio callback while the buffers are laid out again. The delay history is
+    // lost; the lease is reused if it is big enough.
+    suspendProcessing(true);
+    
+    delayStorageFormat = newFormat;
+    
+    if (delayMemory.isValid())
+        allocateDelayMemory();
+    
+    suspendProcessing(false);
+}
+
+void PingPongDelayAudioProcessor::setEconomyFactor (int newFactor)
+{
+    if (newFactor == economyFactor)
+        return;
+    
+    // Same as the storage format: the buffers change size, so the callback is
+    // stopped while they are swapped and the engine starts over at the new rate.
+    // The dry signal isn't delayed, so the host latency stays at zero.
+    suspendProcessing(true);
+    
+    economyFactor = newFactor;
+    
+    if (delayMemory.isValid())
+        allocateDelayMemory();
+    
+    engine.setEconomyFactor(economyFactor);
+    prepareColorationIRs();
+    
+    suspendProcessing(false);
+}
+
+bool PingPongDelayAudioProcessor::setUserFeedbackMatrix (const float* rows, int size)
+{
+    // A few hundred floats, but not to be read half written
+    suspendProcessing(true);
+    const bool ok = engine.setUserFeedbackMatrix(rows, size);
+    suspendProcessing(false);
+    
+    return ok;
+}
+
+bool PingPongDelayAudioProcessor::loadColorationIR (int side, const juce::File& file)
+{
+    AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+    
+    std::unique_ptr<AudioFormatReader> reader (formatManager.createReaderFor(file));
+    if (reader == nullptr || reader->lengthInSamples <= 0 || reader->sampleRate <= 0)
+        return false;
+    
+    // The engine cuts the IR at MAX_LENGTH_MS anyway, no need to read further
+    const int numSamples = (int) jmin(reader->lengthInSamples,
+                                      (juce::int64) (reader->sampleRate*PartitionedConvolver::MAX_LENGTH_MS/1000) + 1);
+    const int numChannels = (int) reader->numChannels;
+    
+    AudioBuffer<float> ir (jmax(numChannels, 1), numSamples);
+    reader->read(&ir, 0, numSamples, 0, true, true);
+    
+    for (int channel = 1; channel < numChannels; ++channel)
+        ir.addFrom(0, 0, ir, channel, 0, numSamples);
+    ir.applyGain(0, 0, numSamples, 1.0f / (float) jmax(numChannels, 1));
+    ir.setSize(1, numSamples, true);
+    
+    const ScopedLock lock (colorationLock);
+    colorationIR[side & 1] = std::move(ir);
+    colorationIRRate[side & 1] = reader->sampleRate;
+    colorationIRName[side & 1] = file.getFileNameWithoutExtension();
+    prepareColorationIR(side & 1);
+    
+    return true;
+}
+
+void PingPongDelayAudioProcessor::clearColorationIR (int side)
+{
+    const ScopedLock lock (colorationLock);
+    colorationIR[side & 1].setSize(0, 0);
+    colorationIRName[side & 1] = {};
+    prepareColorationIR(side & 1);
+}
+
+juce::String PingPongDelayAudioProcessor::getColorationIRName (int side) const
+{
+    const ScopedLock lock (colorationLock);
+    return colorationIRName[side & 1];
+}
+
+void PingPongDelayAudioProcessor::prepareColorationIR (int side)
+{
+    // The FFTs of the partitions are done here; the engine just swaps pointers
+    const auto& ir = colorationIR[side];
+    
+    if (ir.getNumSamples() > 0)
+        engine.setConvolution(side, PartitionedConvolver::create(ir.getReadPointer(0), ir.getNumSamples(),
+                                                                 colorationIRRate[side], engine.getNetworkRate()));
+    else
+        engine.setConvolution(side, nullptr);
+}
+
+void PingPongDelayAudioProcessor::prepareColorationIRs()
+{
+    // Convolvers are made for one network rate, and ignored at any other
+    const ScopedLock lock (colorationLock);
+    
+    if (colorationNetworkRate == engine.getNetworkRate())
+        return;
+    
+    colorationNetworkRate = engine.getNetworkRate();
+    
+    for (int side = 0; side < 2; ++side)
+        if (colorationIR[side].getNumSamples() > 0)
+            prepareColorationIR(side);
+}
+
+#ifndef JucePlugin_PreferredChannelConfigurations
+bool PingPongDelayAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
+{
+  #if JucePlugin_IsMidiEffect
+    juce::ignoreUnused (layouts);
+    return true;
+  #else
+    // This is the place where you check if the layout is supported.
+    // In this template code we only support mono or stereo.
+    // Some plugin hosts, such as certain GarageBand versions, will only
+    // load plugins that support stereo bus layouts.
+    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
+     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+        return false;
+
+    // This checks if the input layout matches the output layout
+   #if ! JucePlugin_IsSynth
+    if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
+        return false;
+
+    // The sidechain for the ducking is optional, mono or stereo
+    if (layouts.inputBuses.size() > 1)
+    {
+        const auto sidechain = layouts.getChannelSet (true, 1);
+        if (! sidechain.isDisabled()
+         && sidechain != juce::AudioChannelSet::mono()
+         && sidechain != juce::AudioChannelSet::stereo())
+            return false;
+    }
+   #endif
+
+    return true;
+  #endif
+}
+#endif
+
+void PingPongDelayAudioProcessor::setLongDelayOptions (size_t ramLimitBytes, const juce::File& spillDirectory)
+{
+    longDelayRamLimitBytes = ramLimitBytes;
+    longDelaySpillDirectory = spillDirectory;
+    longDelayPreparedRate = 0; // rebuild on the next prepareToPlay
+}
+
+//==============================================================================
+// The chunked / spill-file storage of the long delay mode, as engine delay lines
+struct LongDelayLines
+{
+    LongDelayStorage& storage;
+    
+    int getSize() const noexcept { return storage.getCapacity(); }
+    
+    void write (int line, int pos, float value) const noexcept { storage.write(line, pos, value); }
+    float read (int line, int pos) const noexcept { return storage.read(line, pos); }
+    
+    void read4 (int line, int start, float* dest) const noexcept
+    {
+        const int size = storage.getCapacity();
+        for (int k = 0; k < 4; ++k)
+            dest[k] = storage.read(line, start + k < size ? start + k : start + k - size);
+    }
+    
+    void readBackwards (int line, int pos, int count, float* dest) const noexcept
+    {
+        const int size = storage.getCapacity();
+        for (int k = 0; k < count; ++k)
+            dest[k] = storage.read(line, pos - k >= 0 ? pos - k : pos - k + size);
+    }
+};
+
+TapQuality PingPongDelayAudioProcessor::chooseTapQuality (int numSamples)
+{
+    // Bounces have time to spare
+    if (isNonRealtime())
+        return TapQuality::sinc;
+    
+    // Drops to linear as soon as a block runs close to its deadline, and only
+    // goes back after a second of blocks at less than half that load. The
+    // engine crossfades every change.
+    const float share = qualityLoadShare.load();
+    const float load = cpuLoadMeter.getLastLoad();
+    
+    if (! qualityDegraded)
+    {
+        if (share > 0 && load > share)
+        {
+            qualityDegraded = true;
+            calmSamples = 0;
+        }
+    }
+    else if (share <= 0 || load < 0.5f*share)
+    {
+        calmSamples += numSamples;
+        if (calmSamples >= (int) getSampleRate())
+            qualityDegraded = false;
+    }
+    else
+    {
+        calmSamples = 0;
+    }
+    
+    return qualityDegraded ? TapQuality::linear : TapQuality::cubic;
+}
+
+PingPongParameters PingPongDelayAudioProcessor::getEngineParameters() const
+{
+    PingPongParameters p;
+    
+    // Long mode: delay times come from the LONG_DEL params, in seconds
+    if (longModeParam->load() > 0.5f)
+    {
+        p.delayL = longDel_L_Param->load()*1000;
+        p.delayR = longDel_R_Param->load()*1000;
+    }
+    else
+    {
+        p.delayL = del_L_param;
+        p.delayR = del_R_param;
+    }
+    
+    p.feedbackL = feedback_L_param;
+    p.feedbackR = feedback_R_param;
+    p.dryWet = gDryWet_param;
+    p.volumeDb = gVolume_param;
+    p.timeMode = (DelayTimeMode) (int) timeModeParam->load();
+    p.fadeMs = fadeTimeParam->load();
+    p.tapeRate = tapeRateParam->load();
+    p.freeze = freezeParam->load() > 0.5f;
+    p.softLimit = softLimitParam->load() > 0.5f;
+    p.fdnLines = 2 << (int) fdnLinesParam->load();     // 2, 4, 8, 16
+    p.fdnMatrix = (FeedbackMatrixType) (int) fdnMatrixParam->load();
+    p.diffusion = diffusionParam->load();
+    p.shimmer = shimmerParam->load();
+    p.shimmerInterval = (ShimmerInterval) (int) shimmerPitchParam->load();
+    p.reverse = reverseParam->load() > 0.5f;
+    p.drive = driveParam->load();
+    p.bands = 1 + (int) bandsParam->load();        // 1 = off, 2, 3
+    p.crossoverLowHz = crossoverLowParam->load();
+    p.crossoverHighHz = crossoverHighParam->load();
+    
+    for (int band = 0; band < 3; ++band)
+    {
+        p.bandDelayMs[band] = bandDelayParams[band]->load();
+        p.bandFeedback[band] = bandFeedbackParams[band]->load();
+    }
+    
+    p.duckAmount = duckAmountParam->load();
+    p.duckAttackMs = duckAttackParam->load();
+    p.duckReleaseMs = duckReleaseParam->load();
+    p.duckThresholdDb = duckThresholdParam->load();
+    
+    return p;
+}
+
+void PingPongDelayAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+    juce::ScopedNoDenormals noDenormals;
+    CpuLoadMeter::ScopedMeasurement cpuMeasurement (cpuLoadMeter, buffer.getNumSamples());
+    RealtimeSafetyChecker::ScopedAudioThread audioThread (rtViolations);
+    auto totalNumInputChannels  = getTotalNumInputChannels();
+    auto totalNumOutputChannels = getTotalNumOutputChannels();
+
+    for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
+        buffer.clear (i, 0, buffer.getNumSamples());
+    
+    if (! engine.hasDelayMemory())
+        return;
+    
+    runEngine(buffer, false);
+    
+    // Levels are checked by the engine's output guard at the end of each block:
+    // a NaN or runaway clears the delay lines (see getGuardTrips()), and
+    // SOFT_LIMIT keeps the feedback and the output under full scale.
+}
+
+// The host's bypass: the audio goes through untouched, but the engine keeps
+// running on it so un-bypassing doesn't replay the echoes from before.
+void PingPongDelayAudioProcessor::processBlockBypassed (juce::AudioBuffer<float>& buffer, juce::MidiBuffer&)
+{
+    juce::ScopedNoDenormals noDenormals;
+    CpuLoadMeter::ScopedMeasurement cpuMeasurement (cpuLoadMeter, buffer.getNumSamples());
+    RealtimeSafetyChecker::ScopedAudioThread audioThread (rtViolations);
+    
+    for (auto i = getTotalNumInputChannels(); i < getTotalNumOutputChannels(); ++i)
+        buffer.clear (i, 0, buffer.getNumSamples());
+    
+    if (! engine.hasDelayMemory())
+        return;
+    
+    runEngine(buffer, true);
+}
+
+void PingPongDelayAudioProcessor::runEngine (juce::AudioBuffer<float>& buffer, bool bypassed)
+{
+    float* const outputL = buffer.getWritePointer(0);
+    float* const outputR = buffer.getWritePointer(1);
+    const int numSamples = buffer.getNumSamples();
+    
+    auto engineParameters = getEngineParameters();
+    engineParameters.tapQuality = chooseTapQuality(numSamples);
+    engine.setParameters(engineParameters);
+    
+    if (resetPending.exchange(false))
+        engine.reset();
+    
+    // Ducking follows the sidechain bus when the host has one connected
+    if (! bypassed && getChannelCountOfBus(true, 1) > 0)
+    {
+        const auto sidechain = getBusBuffer(buffer, true, 1);
+        engine.setSidechain(sidechain.getReadPointer(0),
+                            sidechain.getNumChannels() > 1 ? sidechain.getReadPointer(1) : nullptr);
+    }
+    
+    // Long mode: the histories come from the chunked storage, otherwise the RAM
+    // buffers. The FDN's lines are short and spread over the whole memory, so
+    // it always uses the RAM buffers, and so do the multiband's.
+    if (longModeParam->load() > 0.5f && longDelayStorage.isPrepared() && engineParameters.fdnLines == 2
+        && engineParameters.bands <= 1)
+    {
+        const LongDelayLines lines { longDelayStorage };
+        
+        if (bypassed)
+            engine.processBypassed(outputL, outputR, numSamples, lines);
+        else
+            engine.process(outputL, outputR, numSamples, lines);
+        
+        int tapDelays[2];
+        engine.getTapReach(tapDelays);
+        longDelayStorage.setPlayheads(engine.getWritePosition(), tapDelays);
+    }
+    else if (bypassed)
+    {
+        engine.processBypassed(outputL, outputR, numSamples);
+    }
+    else
+    {
+        engine.process(outputL, outputR, numSamples);
+    }
+}
+
+//==============================================================================
+bool PingPongDelayAudioProcessor::hasEditor() const
+{
+    return true; // (change this to false if you choose to not supply an editor)
+}
+
+juce::AudioProcessorEditor* PingPongDelayAudioProcessor::createEditor()
+{
+    return new PingPongDelayAudioProcessorEditor (*this);
+}
+
+//==============================================================================
+void PingPongDelayAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
+{
+    // You should use this method to store your parameters in the memory block.
+    // You could do that either as raw data, or use the XML or ValueTree classes
+    // as intermediaries to make it easy to save and load complex data.
+}
+
+void PingPongDelayAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
+{
+    // You should use this method to restore your parameters from this memory block,
+    // whose contents will have been created by the getStateInformation() call.
+}
+
+//==============================================================================
+// This creates new instances of the plugin..
+juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
+{
+    return new PingPongDelayAudioProcessor();
+}
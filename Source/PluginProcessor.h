@@ -1,173 +1,290 @@
-/*
-  ==============================================================================
-
-    This file contains the basic framework code for a JUCE plugin processor.
-
-  ==============================================================================
-*/
-
-#pragma once
-
-#include <JuceHeader.h>
-
-//==============================================================================
-/**
-*/
-class PingPongDelayAudioProcessor  : public juce::AudioProcessor
-{
-public:
-    //==============================================================================
-    PingPongDelayAudioProcessor();
-    ~PingPongDelayAudioProcessor() override;
-
-    //==============================================================================
-    void prepareToPlay (double sampleRate, int samplesPerBlock) override;
-    void releaseResources() override;
-
-   #ifndef JucePlugin_PreferredChannelConfigurations
-    bool isBusesLayoutSupported (const BusesLayout& layouts) const override;
-   #endif
-
-    void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
-
-    //==============================================================================
-    juce::AudioProcessorEditor* createEditor() override;
-    bool hasEditor() const override;
-
-    //==============================================================================
-    const juce::String getName() const override;
-
-    bool acceptsMidi() const override;
-    bool producesMidi() const override;
-    bool isMidiEffect() const override;
-    double getTailLengthSeconds() const override;
-
-    //==============================================================================
-    int getNumPrograms() override;
-    int getCurrentProgram() override;
-    void setCurrentProgram (int index) override;
-    const juce::String getProgramName (int index) override;
-    void changeProgramName (int index, const juce::String& newName) override;
-
-    //==============================================================================
-    void getStateInformation (juce::MemoryBlock& destData) override;
-    void setStateInformation (const void* data, int sizeInBytes) override;
-
-    //==============================================================================
-    // FOR PARAMETERS !
-    juce::AudioProcessorValueTreeState apvts;
-    
-    
-    void set_del_L_param(float val)
-    {
-        del_L_param = val;
-    }
-    void set_del_R_param(float val)
-    {
-        del_R_param = val;
-    }
-    void set_feedback_L_param(float val)
-    {
-        feedback_L_param = val;
-    }
-    void set_feedback_R_param(float val)
-    {
-        feedback_R_param = val;
-    }
-
-    void set_drywet_param(float val)
-    {
-        gDryWet_param = val;
-    }
-    void set_gVolume_param(float val) { gVolume_param = val; }
-
-    
-    // Parameters updated in PluginEditor -> need to be public.
-    float del_L_param_prev;
-    float del_R_param_prev;
-    float feedback_L_param_prev;
-    float feedback_R_param_prev;
-    float gDryWet_param_prev;
-    
-private:
-    //==============================================================================
-    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PingPongDelayAudioProcessor)
-    
-    int BUFFER_SIZE = 262144;
-    
-    std::vector<std::vector<float>> gDelayBuffer_inSig; // delay buffer from input
-    std::vector<int> gWritePointer_inSig; // write pointer for delay buffer from input
-    std::vector<int> gReadPointer_inSig; // read pointer for delay buffer from input
-    
-    std::vector<std::vector<float>> gDelayBuffer_crossSig; // delay buffer loaded from head shadow model
-    std::vector<int> gWritePointer_crossSig; // write pointer for delay buffer loaded from head shadow model
-    std::vector<int> gReadPointer_crossSig; // read pointer for delay buffer loaded from head shadow model
-    
-    int gInitLatency;
-    
-    float crossSig_R = 0;
-    float crossSig_L = 0;
-    float crossSig_R_del_R = 0;
-    float crossSig_R_del_L = 0;
-    float crossSig_L_del_L = 0;
-    float crossSig_L_del_R = 0;
-    float inSig_L_del_L = 0;
-    float inSig_R_del_R = 0;
-    
-//    float feedback_L = 0;
-//    float feedback_R = 0;
-    
-    float a1 = 1;
-    float a2 = 1;
-    float c1 = 1;
-    float c2 = 1;
-
-    float gSampleRate, T;
-    
-//    float del_L;
-//    float del_R;
-    
-    
-    // AUDIO PARAMS
-    juce::AudioProcessorValueTreeState::ParameterLayout createParameters()
-    {
-        std::vector<std::unique_ptr<juce::RangedAudioParameter>> params;
-        
-        params.push_back(std::make_unique<AudioParameterFloat>("DEL_L","Del_L",0.0f,2000.0f,0.0f));
-        params.push_back(std::make_unique<AudioParameterFloat>("DEL_R","Del_R",0.0f,2000.0f,0.0f));
-        params.push_back(std::make_unique<AudioParameterFloat>("FEEDBACK_L","Feedback_L",0.0f,1.0f,0.0f));
-        params.push_back(std::make_unique<AudioParameterFloat>("FEEDBACK_R","Feedback_R",0.0f,1.0f,0.0f));
-        params.push_back(std::make_unique<AudioParameterFloat>("DRY_WET","Dry_Wet",0.0f,1.0f,1.0f)); // in dB
-        params.push_back(std::make_unique<AudioParameterFloat>("VOLUME","Volume",-20.0f,20.0f,0.0f)); // in dB
-
-        return { params.begin(), params.end()};
-    }
-    
-    float del_L_param;
-    float del_R_param;
-    float feedback_L_param;
-    float feedback_R_param;
-    float gVolume_param;
-    float gDryWet_param;
-    
-    float del_L;
-    float del_R;
-    float feedback_L;
-    float feedback_R;
-    float gVolume;
-    float gDryWet;
-    
-    std::vector<float> outVal, outValDry;
-
-    float gFactDry, gFactWet;
-    float drywet;
-    
-//    gDelayBuffer_inSig = zeros(2,BUFFER_SIZE); % no channels x BUFFER_SIZE
-//    gWritePointer_inSig = ones(2,1);
-//    gReadPointer_inSig = ones(2,1);
-//
-//    gDelayBuffer_crossSig = zeros(2,BUFFER_SIZE); % no channels x BUFFER_SIZE
-//    gWritePointer_crossSig = ones(2,1);
-//    gReadPointer_crossSig = ones(2,1);
-    
-};
+/*
+  ==============================================================================
+
+    This file contains the basic framework code for a JUCE plugin processor.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "CpuLoadMeter.h"
+#include "DelayMemoryPool.h"
+#include "LongDelayStorage.h"
+#include "RealtimeSafetyChecker.h"
+#include "Core/PingPongEngine.h"
+
+//==============================================================================
+/**
+*/
+class PingPongDelayAudioProcessor  : public juce::AudioProcessor
+{
+public:
+    //==============================================================================
+    PingPongDelayAudioProcessor();
+    ~PingPongDelayAudioProcessor() override;
+
+    //==============================================================================
+    void prepareToPlay (double sampleRate, int samplesPerBlock) override;
+    void releaseResources() override;
+    void reset() override;
+
+   #ifndef JucePlugin_PreferredChannelConfigurations
+    bool isBusesLayoutSupported (const BusesLayout& layouts) const override;
+   #endif
+
+    void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlockBypassed (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+
+    //==============================================================================
+    juce::AudioProcessorEditor* createEditor() override;
+    bool hasEditor() const override;
+
+    //==============================================================================
+    const juce::String getName() const override;
+
+    bool acceptsMidi() const override;
+    bool producesMidi() const override;
+    bool isMidiEffect() const override;
+    double getTailLengthSeconds() const override;
+
+    //==============================================================================
+    int getNumPrograms() override;
+    int getCurrentProgram() override;
+    void setCurrentProgram (int index) override;
+    const juce::String getProgramName (int index) override;
+    void changeProgramName (int index, const juce::String& newName) override;
+
+    //==============================================================================
+    void getStateInformation (juce::MemoryBlock& destData) override;
+    void setStateInformation (const void* data, int sizeInBytes) override;
+
+    //==============================================================================
+    // FOR PARAMETERS !
+    juce::AudioProcessorValueTreeState apvts;
+    
+    
+    void set_del_L_param(float val)
+    {
+        del_L_param = val;
+    }
+    void set_del_R_param(float val)
+    {
+        del_R_param = val;
+    }
+    void set_feedback_L_param(float val)
+    {
+        feedback_L_param = val;
+    }
+    void set_feedback_R_param(float val)
+    {
+        feedback_R_param = val;
+    }
+
+    void set_drywet_param(float val)
+    {
+        gDryWet_param = val;
+    }
+    void set_gVolume_param(float val) { gVolume_param = val; }
+
+    
+    //==============================================================================
+    // Block timing relative to the real-time budget. Lock-free, can be polled
+    // from the editor or from a host integration aggregating several instances.
+    CpuLoadStats getCpuLoadStats() const { return cpuLoadMeter.getStats(); }
+    const CpuLoadMeter& getCpuLoadMeter() const { return cpuLoadMeter; }
+    void resetCpuLoadStats() { cpuLoadMeter.reset(); }
+    
+    // Debug builds (PINGPONG_RT_CHECKS): calls that aren't real-time safe this
+    // instance made from processBlock since prepareToPlay(). Any thread.
+    const RealtimeSafetyChecker::Violations& getRealtimeViolations() const { return rtViolations; }
+    
+    // Adaptive tap quality: windowed sinc while rendering offline, cubic live,
+    // linear while the block load stays above this share of the deadline
+    // (0 keeps cubic). Any thread.
+    void setQualityLoadShare (float share) { qualityLoadShare = share; }
+    float getQualityLoadShare() const { return qualityLoadShare; }
+    TapQuality getTapQuality() const { return engine.getTapQuality(); }
+    
+    // Blocks the engine's output guard muted because they came out NaN, infinite
+    // or runaway loud (the delay lines are cleared each time). Any thread.
+    unsigned int getGuardTrips() const { return engine.getGuardTrips(); }
+    
+    // Memory held by the delay pool shared between all instances in this process.
+    DelayMemoryPool::Footprint getDelayMemoryFootprint() const { return delayMemoryPool->getFootprint(); }
+    
+    // Opt-in reduced precision storage for the delay histories (see DelaySampleFormat.h).
+    // Call from the message thread; the current delay contents are lost.
+    void setDelayStorageFormat (DelaySampleFormat newFormat);
+    DelaySampleFormat getDelayStorageFormat() const { return delayStorageFormat; }
+    
+    // Economy mode: the delay network runs at 1/2 or 1/4 of the host rate (1 = off),
+    // with proportionally less delay memory. Call from the message thread; the
+    // delay contents are lost. The repeats come getWetLatencySamples() later.
+    void setEconomyFactor (int newFactor);
+    int getEconomyFactor() const { return economyFactor; }
+    int getWetLatencySamples() const { return PingPongEngine::getWetLatencySamples(economyFactor); }
+    
+    // Long delay mode: how much RAM its lines may use before they spill to a
+    // memory-mapped file in spillDirectory. Takes effect on the next prepareToPlay.
+    void setLongDelayOptions (size_t ramLimitBytes, const juce::File& spillDirectory);
+    size_t getLongDelayBytesInRam() const { return longDelayStorage.getBytesInRam(); }
+    bool isLongDelaySpilledToDisk() const { return longDelayStorage.isFileBacked(); }
+    
+    // FDN mode, FDN_MATRIX = User: the matrix, size * size values row by row
+    // (size 4, 8 or 16, matching FDN_LINES). Its rows are orthonormalised.
+    // Call from the message thread.
+    bool setUserFeedbackMatrix (const float* rows, int size);
+    
+    // IRs that colour each repeat of each side (0 = L, 1 = R), with
+    // FEEDBACK_L/R still setting the decay, see Core/PartitionedConvolver.h.
+    // The file is read, mixed to mono and prepared on the calling thread
+    // (never the audio thread) and swapped in at the next block. Returns
+    // false if it can't be read. Call from the message thread.
+    bool loadColorationIR (int side, const juce::File& file);
+    void clearColorationIR (int side);
+    juce::String getColorationIRName (int side) const;
+    
+    static constexpr float MAX_DELAY_MS = 2000.0f;
+    static constexpr float LONG_DELAY_MAX_SECONDS = 300.0f;
+    
+private:
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PingPongDelayAudioProcessor)
+    
+    int BUFFER_SIZE = 262144;   // at least this many samples, more if MAX_DELAY_MS needs it
+    
+    // Delay storage is leased from the process-wide pool: the engine's four
+    // buffers are carved out of one page-aligned block. The pool must outlive the lease.
+    // The lease only ever grows: re-prepares and setting changes that fit reuse it.
+    juce::SharedResourcePointer<DelayMemoryPool> delayMemoryPool;
+    DelayMemoryPool::Lease delayMemory;
+    
+    DelaySampleFormat delayStorageFormat = DelaySampleFormat::float32;
+    int economyFactor = 1;
+    double preparedSampleRate = 44100.0;
+    
+    int getDelayBufferSize() const;
+    void allocateDelayMemory();
+    void freeDelayMemory();
+    
+    // The DSP itself (see Core/PingPongEngine.h); this class feeds it parameters
+    // and storage.
+    PingPongEngine engine;
+    PingPongParameters getEngineParameters() const;
+    void runEngine (juce::AudioBuffer<float>& buffer, bool bypassed);
+    
+    // Set by reset(), which hosts may call from any thread; done at the next block
+    std::atomic<bool> resetPending { false };
+    
+    // Coloration IRs as loaded, at the file's rate, so they can be prepared
+    // again when the network rate changes. The lock keeps prepareToPlay and
+    // the editor from posting at the same time; the audio thread never takes it.
+    juce::AudioBuffer<float> colorationIR[2];
+    double colorationIRRate[2] = { 0, 0 };
+    juce::String colorationIRName[2];
+    double colorationNetworkRate = 0;
+    juce::CriticalSection colorationLock;
+    void prepareColorationIR (int side);
+    void prepareColorationIRs();
+    
+    // Long delay mode storage, prepared for LONG_DELAY_MAX_SECONDS at the current rate
+    LongDelayStorage longDelayStorage;
+    size_t longDelayRamLimitBytes = (size_t) 256 * 1024 * 1024;
+    juce::File longDelaySpillDirectory = juce::File::getSpecialLocation(juce::File::tempDirectory);
+    double longDelayPreparedRate = 0;
+    
+    std::atomic<float>* longModeParam = nullptr;
+    std::atomic<float>* longDel_L_Param = nullptr;
+    std::atomic<float>* longDel_R_Param = nullptr;
+    
+    std::atomic<float>* freezeParam = nullptr;
+    std::atomic<float>* softLimitParam = nullptr;
+    std::atomic<float>* fdnLinesParam = nullptr;
+    std::atomic<float>* fdnMatrixParam = nullptr;
+    std::atomic<float>* diffusionParam = nullptr;
+    std::atomic<float>* shimmerParam = nullptr;
+    std::atomic<float>* shimmerPitchParam = nullptr;
+    std::atomic<float>* reverseParam = nullptr;
+    std::atomic<float>* driveParam = nullptr;
+    std::atomic<float>* bandsParam = nullptr;
+    std::atomic<float>* crossoverLowParam = nullptr;
+    std::atomic<float>* crossoverHighParam = nullptr;
+    std::atomic<float>* bandDelayParams[3] = {};
+    std::atomic<float>* bandFeedbackParams[3] = {};
+    std::atomic<float>* duckAmountParam = nullptr;
+    std::atomic<float>* duckAttackParam = nullptr;
+    std::atomic<float>* duckReleaseParam = nullptr;
+    std::atomic<float>* duckThresholdParam = nullptr;
+    std::atomic<float>* timeModeParam = nullptr;
+    std::atomic<float>* fadeTimeParam = nullptr;
+    std::atomic<float>* tapeRateParam = nullptr;
+    
+    // AUDIO PARAMS
+    juce::AudioProcessorValueTreeState::ParameterLayout createParameters()
+    {
+        std::vector<std::unique_ptr<juce::RangedAudioParameter>> params;
+        
+        params.push_back(std::make_unique<AudioParameterFloat>("DEL_L","Del_L",0.0f,MAX_DELAY_MS,0.0f));
+        params.push_back(std::make_unique<AudioParameterFloat>("DEL_R","Del_R",0.0f,MAX_DELAY_MS,0.0f));
+        params.push_back(std::make_unique<AudioParameterFloat>("FEEDBACK_L","Feedback_L",0.0f,1.0f,0.0f));
+        params.push_back(std::make_unique<AudioParameterFloat>("FEEDBACK_R","Feedback_R",0.0f,1.0f,0.0f));
+        params.push_back(std::make_unique<AudioParameterFloat>("DRY_WET","Dry_Wet",0.0f,1.0f,1.0f)); // in dB
+        params.push_back(std::make_unique<AudioParameterFloat>("VOLUME","Volume",-20.0f,20.0f,0.0f)); // in dB
+        params.push_back(std::make_unique<AudioParameterBool>("LONG_MODE","Long_Mode",false));
+        params.push_back(std::make_unique<AudioParameterFloat>("LONG_DEL_L","Long_Del_L",0.0f,LONG_DELAY_MAX_SECONDS,10.0f)); // in s
+        params.push_back(std::make_unique<AudioParameterFloat>("LONG_DEL_R","Long_Del_R",0.0f,LONG_DELAY_MAX_SECONDS,10.0f)); // in s
+        params.push_back(std::make_unique<AudioParameterBool>("FREEZE","Freeze",false));
+        params.push_back(std::make_unique<AudioParameterChoice>("TIME_MODE","Time_Mode",StringArray { "Jump", "Fade", "Tape" },0));
+        params.push_back(std::make_unique<AudioParameterFloat>("FADE_TIME","Fade_Time",10.0f,2000.0f,200.0f)); // in ms
+        params.push_back(std::make_unique<AudioParameterFloat>("TAPE_RATE","Tape_Rate",0.01f,1.0f,0.5f)); // max delay change in s per s
+        params.push_back(std::make_unique<AudioParameterBool>("SOFT_LIMIT","Soft_Limit",false));
+        params.push_back(std::make_unique<AudioParameterChoice>("FDN_LINES","FDN_Lines",StringArray { "Ping-pong", "FDN 4", "FDN 8", "FDN 16" },0));
+        params.push_back(std::make_unique<AudioParameterChoice>("FDN_MATRIX","FDN_Matrix",StringArray { "Hadamard", "Householder", "User" },0));
+        params.push_back(std::make_unique<AudioParameterFloat>("DIFFUSION","Diffusion",0.0f,1.0f,0.0f));
+        params.push_back(std::make_unique<AudioParameterFloat>("SHIMMER","Shimmer",0.0f,1.0f,0.0f));
+        params.push_back(std::make_unique<AudioParameterChoice>("SHIMMER_PITCH","Shimmer_Pitch",StringArray { "Octave", "Fifth" },0));
+        params.push_back(std::make_unique<AudioParameterBool>("REVERSE","Reverse",false));
+        params.push_back(std::make_unique<AudioParameterFloat>("DRIVE","Drive",0.0f,1.0f,0.0f));
+        params.push_back(std::make_unique<AudioParameterChoice>("BANDS","Bands",StringArray { "Off", "2 bands", "3 bands" },0));
+        params.push_back(std::make_unique<AudioParameterFloat>("CROSSOVER_LOW","Crossover_Low",NormalisableRange<float>(40.0f,2000.0f,0.0f,0.3f),250.0f)); // in Hz
+        params.push_back(std::make_unique<AudioParameterFloat>("CROSSOVER_HIGH","Crossover_High",NormalisableRange<float>(500.0f,12000.0f,0.0f,0.3f),2500.0f)); // in Hz
+        params.push_back(std::make_unique<AudioParameterFloat>("BAND_DEL_LOW","Band_Del_Low",0.0f,MAX_DELAY_MS,450.0f));
+        params.push_back(std::make_unique<AudioParameterFloat>("BAND_DEL_MID","Band_Del_Mid",0.0f,MAX_DELAY_MS,300.0f));
+        params.push_back(std::make_unique<AudioParameterFloat>("BAND_DEL_HIGH","Band_Del_High",0.0f,MAX_DELAY_MS,150.0f));
+        params.push_back(std::make_unique<AudioParameterFloat>("BAND_FEEDBACK_LOW","Band_Feedback_Low",0.0f,1.0f,0.5f));
+        params.push_back(std::make_unique<AudioParameterFloat>("BAND_FEEDBACK_MID","Band_Feedback_Mid",0.0f,1.0f,0.5f));
+        params.push_back(std::make_unique<AudioParameterFloat>("BAND_FEEDBACK_HIGH","Band_Feedback_High",0.0f,1.0f,0.5f));
+        params.push_back(std::make_unique<AudioParameterFloat>("DUCK_AMOUNT","Duck_Amount",0.0f,1.0f,0.0f));
+        params.push_back(std::make_unique<AudioParameterFloat>("DUCK_ATTACK","Duck_Attack",NormalisableRange<float>(0.1f,200.0f,0.0f,0.4f),10.0f)); // in ms
+        params.push_back(std::make_unique<AudioParameterFloat>("DUCK_RELEASE","Duck_Release",NormalisableRange<float>(10.0f,2000.0f,0.0f,0.4f),250.0f)); // in ms
+        params.push_back(std::make_unique<AudioParameterFloat>("DUCK_THRESHOLD","Duck_Threshold",-60.0f,0.0f,-30.0f)); // in dB
+
+        return { params.begin(), params.end()};
+    }
+    
+    float del_L_param;
+    float del_R_param;
+    float feedback_L_param;
+    float feedback_R_param;
+    float gVolume_param;
+    float gDryWet_param;
+    
+    CpuLoadMeter cpuLoadMeter;
+    RealtimeSafetyChecker::Violations rtViolations;
+    
+    std::atomic<float> qualityLoadShare { 0.8f };
+    bool qualityDegraded = false;
+    int calmSamples = 0;     // since the load last went above half the share
+    TapQuality chooseTapQuality (int numSamples);
+    
+//    gDelayBuffer_inSig = zeros(2,BUFFER_SIZE); % no channels x BUFFER_SIZE
+//    gWritePointer_inSig = ones(2,1);
+//    gReadPointer_inSig = ones(2,1);
+//
+//    gDelayBuffer_crossSig = zeros(2,BUFFER_SIZE); % no channels x BUFFER_SIZE
+//    gWritePointer_crossSig = ones(2,1);
+//    gReadPointer_crossSig = ones(2,1);
+    
+};
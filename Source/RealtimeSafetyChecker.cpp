@@ -0,0 +1,268 @@
+/*
+  ==============================================================================
+
+    RealtimeSafetyChecker.cpp
+
+  ==============================================================================
+*/
+
+// The fortified inline versions of open() and read() would clash with the
+// replacements below
+#undef _FORTIFY_SOURCE
+
+#include "RealtimeSafetyChecker.h"
+
+#if PINGPONG_RT_CHECKS
+
+#include <cstdarg>
+#include <cstdlib>
+#include <cstdio>
+#include <new>
+
+#if defined (__GLIBC__)
+ #define PINGPONG_RT_CHECK_LIBC 1
+ #include <dlfcn.h>
+ #include <fcntl.h>
+ #include <pthread.h>
+ #include <unistd.h>
+#else
+ #define PINGPONG_RT_CHECK_LIBC 0
+#endif
+
+#if defined (_WIN32)
+ #include <malloc.h>
+#endif
+
+//==============================================================================
+namespace
+{
+    // The record of the instance whose audio callback is running on this
+    // thread, if any. Read from inside malloc, so it must not allocate on
+    // first use: with initial-exec it is a plain offset from the thread pointer
+   #if defined (__GNUC__)
+    thread_local RealtimeSafetyChecker::Violations* currentOwner __attribute__ ((tls_model ("initial-exec"))) = nullptr;
+   #else
+    thread_local RealtimeSafetyChecker::Violations* currentOwner = nullptr;
+   #endif
+
+    inline void check (const char* entryPoint) noexcept
+    {
+        if (auto* owner = currentOwner)
+            owner->record (entryPoint);
+    }
+}
+
+#if PINGPONG_RT_CHECK_LIBC
+extern "C"
+{
+    // glibc's own allocator, under the names it keeps for exactly this
+    void* __libc_malloc (size_t);
+    void* __libc_calloc (size_t, size_t);
+    void* __libc_realloc (void*, size_t);
+    void __libc_free (void*);
+}
+
+static void* rawMalloc (size_t size) noexcept  { return __libc_malloc (size); }
+static void rawFree (void* p) noexcept         { __libc_free (p); }
+#else
+static void* rawMalloc (size_t size) noexcept  { return std::malloc (size); }
+static void rawFree (void* p) noexcept         { std::free (p); }
+#endif
+
+static void* rawAlignedMalloc (size_t size, size_t alignment) noexcept
+{
+   #if defined (_WIN32)
+    return _aligned_malloc (size, alignment);
+   #else
+    void* p = nullptr;
+    return posix_memalign (&p, alignment < sizeof (void*) ? sizeof (void*) : alignment, size) == 0 ? p : nullptr;
+   #endif
+}
+
+static void rawAlignedFree (void* p) noexcept
+{
+   #if defined (_WIN32)
+    _aligned_free (p);
+   #else
+    rawFree (p);
+   #endif
+}
+
+//==============================================================================
+RealtimeSafetyChecker::ScopedAudioThread::ScopedAudioThread (Violations& owner) noexcept
+    : previous (currentOwner)
+{
+    currentOwner = &owner;
+}
+
+RealtimeSafetyChecker::ScopedAudioThread::~ScopedAudioThread() noexcept
+{
+    currentOwner = previous;
+}
+
+//==============================================================================
+// Replacement global allocation functions, standard C++ on every platform
+void* operator new (std::size_t size)
+{
+    check ("operator new");
+
+    if (void* p = rawMalloc (size > 0 ? size : 1))
+        return p;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[] (std::size_t size)
+{
+    check ("operator new[]");
+
+    if (void* p = rawMalloc (size > 0 ? size : 1))
+        return p;
+
+    throw std::bad_alloc();
+}
+
+void* operator new (std::size_t size, const std::nothrow_t&) noexcept
+{
+    check ("operator new");
+    return rawMalloc (size > 0 ? size : 1);
+}
+
+void* operator new[] (std::size_t size, const std::nothrow_t&) noexcept
+{
+    check ("operator new[]");
+    return rawMalloc (size > 0 ? size : 1);
+}
+
+void* operator new (std::size_t size, std::align_val_t alignment)
+{
+    check ("operator new");
+
+    if (void* p = rawAlignedMalloc (size > 0 ? size : 1, (size_t) alignment))
+        return p;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[] (std::size_t size, std::align_val_t alignment)
+{
+    check ("operator new[]");
+
+    if (void* p = rawAlignedMalloc (size > 0 ? size : 1, (size_t) alignment))
+        return p;
+
+    throw std::bad_alloc();
+}
+
+void operator delete (void* p) noexcept                                { if (p != nullptr) { check ("operator delete"); rawFree (p); } }
+void operator delete[] (void* p) noexcept                              { if (p != nullptr) { check ("operator delete[]"); rawFree (p); } }
+void operator delete (void* p, std::size_t) noexcept                   { operator delete (p); }
+void operator delete[] (void* p, std::size_t) noexcept                 { operator delete[] (p); }
+void operator delete (void* p, const std::nothrow_t&) noexcept         { operator delete (p); }
+void operator delete[] (void* p, const std::nothrow_t&) noexcept       { operator delete[] (p); }
+void operator delete (void* p, std::align_val_t) noexcept              { if (p != nullptr) { check ("operator delete"); rawAlignedFree (p); } }
+void operator delete[] (void* p, std::align_val_t) noexcept            { if (p != nullptr) { check ("operator delete[]"); rawAlignedFree (p); } }
+void operator delete (void* p, std::size_t, std::align_val_t a) noexcept   { operator delete (p, a); }
+void operator delete[] (void* p, std::size_t, std::align_val_t a) noexcept { operator delete[] (p, a); }
+
+//==============================================================================
+#if PINGPONG_RT_CHECK_LIBC
+// The next definition of a libc function, looked up once. dlsym doesn't go
+// through any of the functions replaced here, so this can't recurse.
+template <typename Function>
+static Function nextDefinition (std::atomic<void*>& cache, const char* name) noexcept
+{
+    void* f = cache.load (std::memory_order_relaxed);
+
+    if (f == nullptr)
+    {
+        f = dlsym (RTLD_NEXT, name);
+        cache.store (f, std::memory_order_relaxed);
+    }
+
+    return reinterpret_cast<Function> (f);
+}
+
+extern "C"
+{
+    void* malloc (size_t size) noexcept
+    {
+        check ("malloc");
+        return __libc_malloc (size);
+    }
+
+    void* calloc (size_t count, size_t size) noexcept
+    {
+        check ("calloc");
+        return __libc_calloc (count, size);
+    }
+
+    void* realloc (void* p, size_t size) noexcept
+    {
+        check ("realloc");
+        return __libc_realloc (p, size);
+    }
+
+    void free (void* p) noexcept
+    {
+        if (p != nullptr)
+            check ("free");
+
+        __libc_free (p);
+    }
+
+    int pthread_mutex_lock (pthread_mutex_t* mutex) noexcept
+    {
+        static std::atomic<void*> next { nullptr };
+        check ("pthread_mutex_lock");
+        return nextDefinition<int (*) (pthread_mutex_t*)> (next, "pthread_mutex_lock") (mutex);
+    }
+
+    FILE* fopen (const char* path, const char* mode)
+    {
+        static std::atomic<void*> next { nullptr };
+        check ("fopen");
+        return nextDefinition<FILE* (*) (const char*, const char*)> (next, "fopen") (path, mode);
+    }
+
+    int open (const char* path, int flags, ...)
+    {
+        static std::atomic<void*> next { nullptr };
+        check ("open");
+
+        // The mode argument is only there when a file may be created
+        mode_t mode = 0;
+       #ifdef O_TMPFILE
+        const bool hasMode = (flags & O_CREAT) != 0 || (flags & O_TMPFILE) == O_TMPFILE;
+       #else
+        const bool hasMode = (flags & O_CREAT) != 0;
+       #endif
+
+        if (hasMode)
+        {
+            va_list args;
+            va_start (args, flags);
+            mode = (mode_t) va_arg (args, unsigned int);
+            va_end (args);
+        }
+
+        return nextDefinition<int (*) (const char*, int, ...)> (next, "open") (path, flags, mode);
+    }
+
+    ssize_t read (int fd, void* buffer, size_t size)
+    {
+        static std::atomic<void*> next { nullptr };
+        check ("read");
+        return nextDefinition<ssize_t (*) (int, void*, size_t)> (next, "read") (fd, buffer, size);
+    }
+
+    ssize_t write (int fd, const void* buffer, size_t size)
+    {
+        static std::atomic<void*> next { nullptr };
+        check ("write");
+        return nextDefinition<ssize_t (*) (int, const void*, size_t)> (next, "write") (fd, buffer, size);
+    }
+}
+#endif
+
+#endif
@@ -0,0 +1,95 @@
+/*
+  ==============================================================================
+
+    RealtimeSafetyChecker.h
+    Debug check that nothing on the audio thread allocates, locks or does
+    file I/O.
+
+    Built in when PINGPONG_RT_CHECKS is 1 (the Debug configurations set it).
+    processBlock marks its scope with ScopedAudioThread, and the entry
+    points below are replaced for the whole binary and count any call made
+    inside such a scope:
+
+      - global operator new / delete (every platform)
+      - malloc, calloc, realloc, free, pthread_mutex_lock, open, fopen,
+        read and write (Linux / glibc, where they can be interposed)
+
+    A hit is recorded against the Violations of the instance whose scope is
+    open on that thread, with relaxed atomic stores and nothing else, so the
+    check itself stays real-time safe. Each processor clears its record in
+    prepareToPlay() and asserts it is still clear in releaseResources(), and
+    the editor shows it in the status line next to the block time
+    percentiles, so a regression shows up in any debug session with a host
+    or pluginval. Tools/RealtimeSafetyHost drives processBlock with random
+    block sizes, rates and automation and fails if any instance is hit.
+
+    The replacement functions only see calls that resolve to them: all of
+    them in the Standalone build and Tools/RealtimeSafetyHost, which are
+    executables. In a plugin binary loaded by a host, they see operator
+    new / delete from the plugin's own code and JUCE, which is where the
+    allocations come from.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+
+#ifndef PINGPONG_RT_CHECKS
+ #define PINGPONG_RT_CHECKS 0
+#endif
+
+//==============================================================================
+namespace RealtimeSafetyChecker
+{
+    // Forbidden calls made inside one instance's ScopedAudioThread since the
+    // last reset. Any thread.
+    class Violations
+    {
+    public:
+        unsigned int getCount() const noexcept  { return count.load (std::memory_order_relaxed); }
+
+        // Name of the entry point of the latest one, or nullptr
+        const char* getLast() const noexcept    { return last.load (std::memory_order_relaxed); }
+
+        void reset() noexcept
+        {
+            count.store (0, std::memory_order_relaxed);
+            last.store (nullptr, std::memory_order_relaxed);
+        }
+
+        void record (const char* entryPoint) noexcept
+        {
+            count.fetch_add (1, std::memory_order_relaxed);
+            last.store (entryPoint, std::memory_order_relaxed);
+        }
+
+    private:
+        std::atomic<unsigned int> count { 0 };
+        std::atomic<const char*> last { nullptr };
+    };
+
+    // Marks the audio callback on the current thread; hits inside it count
+    // against the given Violations. Nests.
+    struct ScopedAudioThread
+    {
+       #if PINGPONG_RT_CHECKS
+        explicit ScopedAudioThread (Violations& owner) noexcept;
+        ~ScopedAudioThread() noexcept;
+       #else
+        explicit ScopedAudioThread (Violations&) noexcept {}
+       #endif
+
+        ScopedAudioThread (const ScopedAudioThread&) = delete;
+        ScopedAudioThread& operator= (const ScopedAudioThread&) = delete;
+
+       #if PINGPONG_RT_CHECKS
+    private:
+        Violations* previous;
+       #endif
+    };
+
+    // Whether the checks are built in at all
+    constexpr bool isEnabled() noexcept { return PINGPONG_RT_CHECKS != 0; }
+}
@@ -0,0 +1,474 @@
+/*
+  ==============================================================================
+
+    PingPongSweep.cpp
+    Offline preset QA: renders the impulse response of every point of a
+    parameter grid and writes a line of metrics per point.
+
+    Each worker thread has its own engine (through the C interface in
+    Source/Core, so no JUCE) and takes the next grid point from a shared
+    counter, so the sweep scales with the number of cores. Per point it
+    lets the parameter smoothing settle on silence, feeds in one impulse
+    and renders the rest of the response.
+
+    Build:
+
+        c++ -std=c++17 -O2 -ISource/Core Tools/PingPongSweep.cpp
+            Source/Core/PingPongCore.cpp Source/Core/PingPongKernels.cpp
+            -pthread -o PingPongSweep
+
+    Each grid is a single value, a list (100,250,375) or first:last:count,
+    e.g.
+
+        PingPongSweep --del-l 50:1000:20 --del-r 50:1000:20 --fb-l 0:0.9:5
+                      --fb-r 0.5 --dry-wet 1 --seconds 8 --out sweep.csv
+
+    Columns of the CSV, one row per point in grid order:
+
+        del_l, del_r, fb_l, fb_r, dry_wet   the point
+        peak_db                             largest |sample| of either side
+        energy_l_db, energy_r_db            total energy of each side
+        balance_db                          energy_l_db - energy_r_db
+        decay_s                             RT60-like: how long the response
+                                            stays within 60 dB of its peak,
+                                            extrapolated along the echoes'
+                                            peaks past the end of the render
+                                            (inf if they don't die away)
+        echoes                              repeats (the dry impulse included)
+                                            within 40 dB of the peak
+        guard_trips                         blocks the output guard muted
+
+    The taps use the sinc interpolation of offline renders unless --quality
+    says otherwise (1 = cubic, as played live, about twice as fast).
+
+    --ir-dir DIR also writes each response as a 32-bit float stereo WAV,
+    named by the point's index.
+
+  ==============================================================================
+*/
+
+#include "PingPongCore.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+//==============================================================================
+namespace
+{
+    struct Options
+    {
+        std::vector<float> grids[5] = { { 375 }, { 375 }, { 0.5f }, { 0.5f }, { 1 } };
+        double sampleRate = 48000;
+        double seconds = 10;
+        int quality = 2;    // sinc, what the plugin uses for bounces
+        int numThreads = (int) std::max (1u, std::thread::hardware_concurrency());
+        std::string outPath = "sweep.csv";
+        std::string irDirectory;
+    };
+
+    struct Point
+    {
+        float delayL, delayR, feedbackL, feedbackR, dryWet;
+    };
+
+    struct Metrics
+    {
+        float peakDb = 0, energyLDb = 0, energyRDb = 0, decaySeconds = 0;
+        int echoes = 0;
+        unsigned int guardTrips = 0;
+    };
+
+    const char* const gridNames[] = { "--del-l", "--del-r", "--fb-l", "--fb-r", "--dry-wet" };
+
+    constexpr int BLOCK_SIZE = 512;
+    constexpr int SETTLE_SAMPLES = 4096;    // delay smoothing is 0.99 per sample
+
+    //==============================================================================
+    bool parseGrid (const char* text, std::vector<float>& grid)
+    {
+        grid.clear();
+        float first, last;
+        int count;
+
+        if (std::sscanf (text, "%f:%f:%d", &first, &last, &count) == 3)
+        {
+            if (count < 1)
+                return false;
+
+            for (int i = 0; i < count; ++i)
+                grid.push_back (count == 1 ? first : first + (last - first) * (float) i / (float) (count - 1));
+
+            return true;
+        }
+
+        for (const char* p = text; *p != 0; )
+        {
+            char* end = nullptr;
+            grid.push_back (std::strtof (p, &end));
+
+            if (end == p)
+                return false;
+
+            p = *end == ',' ? end + 1 : end;
+        }
+
+        return ! grid.empty();
+    }
+
+    bool parseOptions (int argc, char** argv, Options& options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string arg = argv[i];
+
+            if (i + 1 >= argc)
+                return false;
+
+            const char* value = argv[++i];
+            bool known = false;
+
+            for (int g = 0; g < 5; ++g)
+            {
+                if (arg == gridNames[g])
+                {
+                    if (! parseGrid (value, options.grids[g]))
+                        return false;
+
+                    known = true;
+                }
+            }
+
+            if (arg == "--rate")         { options.sampleRate = std::atof (value); known = options.sampleRate > 0; }
+            else if (arg == "--seconds") { options.seconds = std::atof (value); known = options.seconds > 0; }
+            else if (arg == "--quality") { options.quality = std::atoi (value); known = options.quality >= 0 && options.quality <= 2; }
+            else if (arg == "--threads") { options.numThreads = std::max (1, std::atoi (value)); known = true; }
+            else if (arg == "--out")     { options.outPath = value; known = true; }
+            else if (arg == "--ir-dir")  { options.irDirectory = value; known = true; }
+
+            if (! known)
+                return false;
+        }
+
+        return true;
+    }
+
+    Point getPoint (const Options& options, size_t index)
+    {
+        // Last grid varies fastest
+        float values[5];
+
+        for (int g = 4; g >= 0; --g)
+        {
+            const auto& grid = options.grids[g];
+            values[g] = grid[index % grid.size()];
+            index /= grid.size();
+        }
+
+        return { values[0], values[1], values[2], values[3], values[4] };
+    }
+
+    float toDb (double power)
+    {
+        return power > 0 ? (float) (10 * std::log10 (power)) : -INFINITY;
+    }
+
+    //==============================================================================
+    // How long the response stays within 60 dB of its loudest 10 ms window:
+    // the time from that window to the last one above the floor. Windows
+    // above it in a row make up one echo (or a continuous tail). If the
+    // render ends before the echoes are out, less than the longest gap
+    // between two of them after the last, the rest is extrapolated along a
+    // line fitted through the echoes' peaks (through the windows of a lone
+    // continuous tail). A loop that doesn't recirculate thus reports the
+    // time of its last echo, and more of either feedback never means less.
+    float measureDecay (const std::vector<float>& left, const std::vector<float>& right, double sampleRate)
+    {
+        const size_t window = std::max ((size_t) 1, (size_t) (sampleRate / 100));
+        std::vector<double> levels;
+
+        for (size_t start = 0; start < left.size(); start += window)
+        {
+            double energy = 0;
+            for (size_t i = start; i < std::min (start + window, left.size()); ++i)
+                energy += (double) left[i]*left[i] + (double) right[i]*right[i];
+
+            levels.push_back (energy > 0 ? 10 * std::log10 (energy) : -1000.0);
+        }
+
+        const size_t loudest = (size_t) (std::max_element (levels.begin(), levels.end()) - levels.begin());
+        const double floor = levels[loudest] - 60;
+        const double secondsPerWindow = (double) window / sampleRate;
+
+        // Each echo's loudest window, from the loudest one on
+        std::vector<size_t> peaks;
+        size_t last = loudest, longestGap = 0;
+
+        for (size_t w = loudest; w < levels.size(); ++w)
+        {
+            if (levels[w] < floor)
+                continue;
+
+            if (peaks.empty() || w > last + 1)
+            {
+                longestGap = std::max (longestGap, w - last);
+                peaks.push_back (w);
+            }
+            else if (levels[w] > levels[peaks.back()])
+            {
+                peaks.back() = w;
+            }
+
+            last = w;
+        }
+
+        const size_t remaining = levels.size() - 1 - last;
+        const bool ended = peaks.size() > 1 ? remaining > longestGap : remaining > 0;
+        const double measured = (double) (last - loudest) * secondsPerWindow;
+
+        if (ended)
+            return (float) measured;
+
+        // A lone tail running into the end: its windows are its envelope
+        if (peaks.size() == 1)
+            for (size_t w = loudest + 1; w <= last; ++w)
+                peaks.push_back (w);
+
+        double sumT = 0, sumL = 0, sumTT = 0, sumTL = 0;
+        const double count = (double) peaks.size();
+
+        for (auto w : peaks)
+        {
+            const double t = (double) (w - loudest) * secondsPerWindow;
+            sumT += t; sumL += levels[w]; sumTT += t*t; sumTL += t*levels[w];
+        }
+
+        if (peaks.size() < 2)
+            return INFINITY;
+
+        const double slope = (count*sumTL - sumT*sumL) / (count*sumTT - sumT*sumT);
+        if (slope >= 0)
+            return INFINITY;
+
+        // Where the line crosses the floor, but no earlier than what was heard
+        const double offset = (sumL - slope*sumT) / count;
+        return (float) std::max (measured, (floor - offset) / slope);
+    }
+
+    // Repeats: the loudest sample of each stretch above -40 dB of the peak,
+    // counting stretches at least a millisecond apart (interpolation ringing
+    // around a repeat is part of it)
+    int countEchoes (const std::vector<float>& left, const std::vector<float>& right, float peak, double sampleRate)
+    {
+        const float threshold = peak * 0.01f;
+        const size_t minGap = (size_t) (sampleRate / 1000);
+        size_t lastAbove = 0;
+        int echoes = 0;
+
+        for (size_t i = 0; i < left.size(); ++i)
+        {
+            if (std::max (std::fabs (left[i]), std::fabs (right[i])) < threshold)
+                continue;
+
+            if (echoes == 0 || i - lastAbove > minGap)
+                ++echoes;
+
+            lastAbove = i;
+        }
+
+        return echoes;
+    }
+
+    //==============================================================================
+    bool writeWav (const std::string& path, const std::vector<float>& left, const std::vector<float>& right, double sampleRate)
+    {
+        FILE* f = std::fopen (path.c_str(), "wb");
+        if (f == nullptr)
+            return false;
+
+        const uint32_t numFrames = (uint32_t) left.size();
+        const uint32_t dataBytes = numFrames * 2 * 4;
+        const uint32_t rate = (uint32_t) sampleRate;
+
+        auto u32 = [f] (uint32_t v) { unsigned char b[4] = { (unsigned char) v, (unsigned char) (v >> 8), (unsigned char) (v >> 16), (unsigned char) (v >> 24) }; std::fwrite (b, 1, 4, f); };
+        auto u16 = [f] (uint16_t v) { unsigned char b[2] = { (unsigned char) v, (unsigned char) (v >> 8) }; std::fwrite (b, 1, 2, f); };
+
+        std::fwrite ("RIFF", 1, 4, f);  u32 (36 + dataBytes);
+        std::fwrite ("WAVEfmt ", 1, 8, f);
+        u32 (16); u16 (3); u16 (2); u32 (rate); u32 (rate * 8); u16 (8); u16 (32);     // IEEE float, stereo
+        std::fwrite ("data", 1, 4, f);  u32 (dataBytes);
+
+        std::vector<float> frames (2 * (size_t) numFrames);
+        for (size_t i = 0; i < numFrames; ++i)
+        {
+            frames[2*i] = left[i];
+            frames[2*i + 1] = right[i];
+        }
+
+        // Little-endian hosts only, like the rest of the tool's users
+        const bool ok = std::fwrite (frames.data(), sizeof (float), frames.size(), f) == frames.size();
+        return std::fclose (f) == 0 && ok;
+    }
+
+    //==============================================================================
+    void runWorker (const Options& options, std::atomic<size_t>& nextPoint, size_t numPoints,
+                    std::vector<Metrics>& results, std::atomic<size_t>& numDone)
+    {
+        float maxDelay = 0;
+        for (int g = 0; g < 2; ++g)
+            for (float d : options.grids[g])
+                maxDelay = std::max (maxDelay, d);
+
+        const size_t size = ppd_memory_size (maxDelay, options.sampleRate, PPD_FORMAT_FLOAT32);
+        const size_t alignment = ppd_memory_alignment();
+        std::vector<char> storage (size + alignment);
+        void* memory = storage.data() + (alignment - (uintptr_t) storage.data() % alignment) % alignment;
+
+        ppd_engine* engine = ppd_create (memory, size, maxDelay, options.sampleRate, PPD_FORMAT_FLOAT32);
+        if (engine == nullptr)
+            return;
+
+        ppd_set_param (engine, PPD_PARAM_QUALITY, (float) options.quality);
+
+        const size_t length = (size_t) (options.seconds * options.sampleRate);
+        std::vector<float> left (length), right (length);
+        float silenceL[BLOCK_SIZE], silenceR[BLOCK_SIZE];
+
+        for (size_t index; (index = nextPoint.fetch_add (1)) < numPoints;)
+        {
+            const Point point = getPoint (options, index);
+
+            ppd_reset (engine);
+            ppd_set_param (engine, PPD_PARAM_DELAY_L, point.delayL);
+            ppd_set_param (engine, PPD_PARAM_DELAY_R, point.delayR);
+            ppd_set_param (engine, PPD_PARAM_FEEDBACK_L, point.feedbackL);
+            ppd_set_param (engine, PPD_PARAM_FEEDBACK_R, point.feedbackR);
+            ppd_set_param (engine, PPD_PARAM_DRY_WET, point.dryWet);
+
+            const unsigned int tripsBefore = ppd_get_guard_trips (engine);
+
+            // The smoothed parameters start from zero after a reset; let them
+            // arrive before the impulse so it sees the point's settings
+            for (int done = 0; done < SETTLE_SAMPLES; done += BLOCK_SIZE)
+            {
+                std::fill (silenceL, silenceL + BLOCK_SIZE, 0.0f);
+                std::fill (silenceR, silenceR + BLOCK_SIZE, 0.0f);
+                ppd_process (engine, silenceL, silenceR, BLOCK_SIZE);
+            }
+
+            std::fill (left.begin(), left.end(), 0.0f);
+            std::fill (right.begin(), right.end(), 0.0f);
+            left[0] = right[0] = 1;
+
+            for (size_t start = 0; start < length; start += BLOCK_SIZE)
+                ppd_process (engine, left.data() + start, right.data() + start, (int) std::min ((size_t) BLOCK_SIZE, length - start));
+
+            Metrics m;
+            double energyL = 0, energyR = 0;
+            float peak = 0;
+
+            for (size_t i = 0; i < length; ++i)
+            {
+                energyL += (double) left[i]*left[i];
+                energyR += (double) right[i]*right[i];
+                peak = std::max ({ peak, std::fabs (left[i]), std::fabs (right[i]) });
+            }
+
+            m.peakDb = toDb ((double) peak*peak);
+            m.energyLDb = toDb (energyL);
+            m.energyRDb = toDb (energyR);
+            m.decaySeconds = measureDecay (left, right, options.sampleRate);
+            m.echoes = countEchoes (left, right, peak, options.sampleRate);
+            m.guardTrips = ppd_get_guard_trips (engine) - tripsBefore;
+            results[index] = m;
+
+            if (! options.irDirectory.empty())
+            {
+                char name[32];
+                std::snprintf (name, sizeof (name), "/ir_%06zu.wav", index);
+
+                if (! writeWav (options.irDirectory + name, left, right, options.sampleRate))
+                    std::fprintf (stderr, "Couldn't write %s%s\n", options.irDirectory.c_str(), name);
+            }
+
+            numDone.fetch_add (1);
+        }
+
+        ppd_destroy (engine);
+    }
+
+    void printUsage()
+    {
+        std::fprintf (stderr,
+                      "Usage: PingPongSweep [--del-l G] [--del-r G] [--fb-l G] [--fb-r G] [--dry-wet G]\n"
+                      "                     [--rate Hz] [--seconds S] [--quality Q] [--threads N] [--out FILE.csv] [--ir-dir DIR]\n"
+                      "G is a value, a list (a,b,c) or first:last:count. Delays in ms.\n"
+                      "Q is the tap interpolation: 0 linear, 1 cubic, 2 sinc (default, as in bounces).\n");
+    }
+}
+
+//==============================================================================
+int main (int argc, char** argv)
+{
+    Options options;
+
+    if (! parseOptions (argc, argv, options))
+    {
+        printUsage();
+        return 1;
+    }
+
+    size_t numPoints = 1;
+    for (const auto& grid : options.grids)
+        numPoints *= grid.size();
+
+    std::vector<Metrics> results (numPoints);
+    std::atomic<size_t> nextPoint { 0 }, numDone { 0 };
+
+    const int numThreads = (int) std::min ((size_t) options.numThreads, numPoints);
+    std::vector<std::thread> workers;
+
+    for (int t = 0; t < numThreads; ++t)
+        workers.emplace_back (runWorker, std::cref (options), std::ref (nextPoint), numPoints,
+                              std::ref (results), std::ref (numDone));
+
+    for (auto& worker : workers)
+        worker.join();
+
+    if (numDone.load() != numPoints)
+    {
+        std::fprintf (stderr, "Couldn't create the engines\n");
+        return 1;
+    }
+
+    FILE* out = std::fopen (options.outPath.c_str(), "w");
+    if (out == nullptr)
+    {
+        std::fprintf (stderr, "Couldn't write %s\n", options.outPath.c_str());
+        return 1;
+    }
+
+    std::fprintf (out, "del_l,del_r,fb_l,fb_r,dry_wet,peak_db,energy_l_db,energy_r_db,balance_db,decay_s,echoes,guard_trips\n");
+
+    for (size_t i = 0; i < numPoints; ++i)
+    {
+        const Point p = getPoint (options, i);
+        const Metrics& m = results[i];
+
+        std::fprintf (out, "%g,%g,%g,%g,%g,%.2f,%.2f,%.2f,%.2f,%.3f,%d,%u\n",
+                      p.delayL, p.delayR, p.feedbackL, p.feedbackR, p.dryWet,
+                      m.peakDb, m.energyLDb, m.energyRDb, m.energyLDb - m.energyRDb,
+                      m.decaySeconds, m.echoes, m.guardTrips);
+    }
+
+    std::fclose (out);
+    std::printf ("%zu points, %d threads -> %s\n", numPoints, numThreads, options.outPath.c_str());
+    return 0;
+}
@@ -0,0 +1,277 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Real-time safety host: drives PingPongDelayAudioProcessor::processBlock
+    the way a host would, with PINGPONG_RT_CHECKS built in, and fails if
+    any block allocates, locks or does file I/O.
+
+    Each run picks a random sample rate, maximum block size, Economy
+    factor, delay storage format, user matrix and offline flag, prepares
+    every instance, then renders the given number of seconds in blocks of
+    random size (up to the maximum) with random noise on the input and the
+    sidechain. Between blocks, as a host's automation would, it sets random
+    parameters to random values, and now and then bypasses a block or
+    calls reset(). The instances run one after the other on this thread,
+    and each one's violations are checked at the end of every run (they
+    are cleared by prepareToPlay), so a hit names the instance and the
+    settings of the run it happened in.
+
+    At the end it prints the percentiles of the block times, in
+    microseconds and as a share of each block's real-time budget, over
+    all runs. The exit code is 1 if any instance made a forbidden call.
+
+    Build: open RealtimeSafetyHost.jucer in the Projucer (it expects JUCE
+    where PingPongDelay.jucer does) and build the exporter for the platform.
+    The libc entry points are only checked on Linux, so run it there for
+    the full set (see Source/RealtimeSafetyChecker.h).
+
+        RealtimeSafetyHost --runs 20 --seconds 10 --instances 2 --seed 1
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../Source/PluginProcessor.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+static_assert (RealtimeSafetyChecker::isEnabled(), "The host needs PINGPONG_RT_CHECKS=1");
+
+//==============================================================================
+namespace
+{
+    struct Options
+    {
+        int runs = 20;
+        double seconds = 10;
+        int numInstances = 2;
+        juce::int64 seed = 1;
+    };
+
+    const double sampleRates[] = { 22050, 44100, 48000, 88200, 96000, 176400, 192000 };
+    const int maxBlockSizes[] = { 16, 32, 64, 128, 256, 441, 512, 1024, 2048, 4096 };
+    const int economyFactors[] = { 1, 2, 4 };
+    const int matrixSizes[] = { 4, 8, 16 };
+
+    // Chance per block that a given parameter moves
+    constexpr float AUTOMATION_CHANCE = 0.05f;
+    constexpr float BYPASS_CHANCE = 0.01f;
+    constexpr float RESET_CHANCE = 0.002f;
+
+    //==============================================================================
+    bool parseOptions (int argc, char** argv, Options& options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string arg = argv[i];
+
+            if (i + 1 >= argc)
+                return false;
+
+            const char* value = argv[++i];
+            bool known = false;
+
+            if (arg == "--runs")           { options.runs = std::atoi (value); known = options.runs > 0; }
+            else if (arg == "--seconds")   { options.seconds = std::atof (value); known = options.seconds > 0; }
+            else if (arg == "--instances") { options.numInstances = std::atoi (value); known = options.numInstances > 0; }
+            else if (arg == "--seed")      { options.seed = std::atoll (value); known = true; }
+
+            if (! known)
+                return false;
+        }
+
+        return true;
+    }
+
+    void printUsage()
+    {
+        std::fprintf (stderr,
+                      "Usage: RealtimeSafetyHost [--runs N] [--seconds S] [--instances N] [--seed N]\n"
+                      "Renders S seconds per run and instance with random rates, block sizes and automation.\n"
+                      "Fails (exit code 1) if processBlock makes a call that isn't real-time safe.\n");
+    }
+
+    template <typename Array>
+    auto pick (juce::Random& random, const Array& values)
+    {
+        return values[random.nextInt ((int) std::size (values))];
+    }
+
+    // Any orthogonal matrix will do: a random rotation of the first two
+    // rows of the identity
+    void setRandomUserMatrix (PingPongDelayAudioProcessor& processor, juce::Random& random)
+    {
+        const int size = pick (random, matrixSizes);
+        std::vector<float> rows ((size_t) (size * size), 0.0f);
+
+        for (int i = 0; i < size; ++i)
+            rows[(size_t) (i * size + i)] = 1.0f;
+
+        const float angle = random.nextFloat() * juce::MathConstants<float>::twoPi;
+        rows[0] = std::cos (angle);
+        rows[1] = -std::sin (angle);
+        rows[(size_t) size] = std::sin (angle);
+        rows[(size_t) size + 1] = std::cos (angle);
+
+        processor.setUserFeedbackMatrix (rows.data(), size);
+    }
+
+    void automate (juce::AudioProcessor& processor, juce::Random& random)
+    {
+        for (auto* parameter : processor.getParameters())
+            if (random.nextFloat() < AUTOMATION_CHANCE)
+                parameter->setValueNotifyingHost (random.nextFloat());
+    }
+
+    void fillNoise (juce::AudioBuffer<float>& buffer, int numSamples, juce::Random& random)
+    {
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+        {
+            auto* data = buffer.getWritePointer (ch);
+
+            for (int i = 0; i < numSamples; ++i)
+                data[i] = random.nextFloat() * 0.5f - 0.25f;
+        }
+    }
+
+    double percentile (const std::vector<double>& sorted, double p)
+    {
+        if (sorted.empty())
+            return 0;
+
+        const auto rank = (int) std::ceil (p * (double) sorted.size()) - 1;
+        return sorted[(size_t) juce::jlimit (0, (int) sorted.size() - 1, rank)];
+    }
+
+    void printPercentiles (const char* name, std::vector<double> values, double scale, const char* unit)
+    {
+        std::sort (values.begin(), values.end());
+        std::printf ("%-10s p50 %8.2f  p90 %8.2f  p99 %8.2f  p99.9 %8.2f  max %8.2f %s\n", name,
+                     percentile (values, 0.5) * scale, percentile (values, 0.9) * scale,
+                     percentile (values, 0.99) * scale, percentile (values, 0.999) * scale,
+                     (values.empty() ? 0.0 : values.back()) * scale, unit);
+    }
+}
+
+//==============================================================================
+int main (int argc, char** argv)
+{
+    Options options;
+
+    if (! parseOptions (argc, argv, options))
+    {
+        printUsage();
+        return 1;
+    }
+
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    juce::Random random (options.seed);
+
+    std::vector<std::unique_ptr<PingPongDelayAudioProcessor>> instances;
+    for (int i = 0; i < options.numInstances; ++i)
+    {
+        instances.push_back (std::make_unique<PingPongDelayAudioProcessor>());
+        instances.back()->enableAllBuses();     // the sidechain too
+    }
+
+    const int numChannels = std::max (instances[0]->getTotalNumInputChannels(),
+                                      instances[0]->getTotalNumOutputChannels());
+    std::vector<double> micros, loads;
+    int numFailures = 0;
+
+    for (int run = 0; run < options.runs; ++run)
+    {
+        const double sampleRate = pick (random, sampleRates);
+        const int maxBlockSize = pick (random, maxBlockSizes);
+        const int economyFactor = pick (random, economyFactors);
+        const auto format = (DelaySampleFormat) random.nextInt (3);
+        const bool offline = random.nextInt (4) == 0;
+
+        // Everything a host does off the audio thread: the setters and
+        // prepareToPlay() may allocate
+        for (auto& processor : instances)
+        {
+            processor->setEconomyFactor (economyFactor);
+            processor->setDelayStorageFormat (format);
+            setRandomUserMatrix (*processor, random);
+            processor->setNonRealtime (offline);
+            processor->setRateAndBufferSizeDetails (sampleRate, maxBlockSize);
+            processor->prepareToPlay (sampleRate, maxBlockSize);
+        }
+
+        juce::AudioBuffer<float> buffer (numChannels, maxBlockSize);
+        juce::MidiBuffer midi;
+        const auto totalSamples = (juce::int64) (options.seconds * sampleRate);
+
+        for (auto& processor : instances)
+        {
+            for (juce::int64 done = 0; done < totalSamples; )
+            {
+                const int numSamples = (int) std::min ((juce::int64) (random.nextBool() ? maxBlockSize : 1 + random.nextInt (maxBlockSize)),
+                                                       totalSamples - done);
+
+                automate (*processor, random);
+                if (random.nextFloat() < RESET_CHANCE)
+                    processor->reset();
+
+                fillNoise (buffer, numSamples, random);
+                juce::AudioBuffer<float> block (buffer.getArrayOfWritePointers(), numChannels, numSamples);
+                const bool bypassed = random.nextFloat() < BYPASS_CHANCE;
+
+                // As a host does: the callback lock is what suspendProcessing() waits on
+                const juce::ScopedLock callbackLock (processor->getCallbackLock());
+                const auto start = std::chrono::steady_clock::now();
+
+                if (bypassed)
+                    processor->processBlockBypassed (block, midi);
+                else
+                    processor->processBlock (block, midi);
+
+                const std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+                micros.push_back (elapsed.count());
+                loads.push_back (elapsed.count() * 1.0e-6 * sampleRate / numSamples);
+                done += numSamples;
+            }
+        }
+
+        for (size_t i = 0; i < instances.size(); ++i)
+        {
+            const auto& violations = instances[i]->getRealtimeViolations();
+
+            if (violations.getCount() > 0)
+            {
+                const char* last = violations.getLast();
+                std::fprintf (stderr, "FAIL run %d, instance %d: %u calls that aren't real-time safe, the last one %s "
+                                      "(%.0f Hz, blocks up to %d, Economy %d, format %d%s)\n",
+                              run, (int) i, violations.getCount(), last != nullptr ? last : "?",
+                              sampleRate, maxBlockSize, economyFactor, (int) format, offline ? ", offline" : "");
+                ++numFailures;
+            }
+
+            instances[i]->releaseResources();
+        }
+    }
+
+    std::printf ("%d runs of %g s on %d instances, %d blocks\n", options.runs, options.seconds,
+                 options.numInstances, (int) micros.size());
+    printPercentiles ("block time", micros, 1.0, "us");
+    printPercentiles ("block load", loads, 100.0, "% of budget");
+
+    if (numFailures > 0)
+    {
+        std::fprintf (stderr, "%d instance runs made calls that aren't real-time safe\n", numFailures);
+        return 1;
+    }
+
+    std::printf ("No calls that aren't real-time safe\n");
+    return 0;
+}